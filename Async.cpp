@@ -0,0 +1,30 @@
+//agassinoa20@gmail.com
+#include "Async.hpp"
+
+namespace matrix {
+
+std::future<SquareMat> multiplyAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool) {
+    return pool.submit([a, b] { return a * b; });
+}
+
+std::future<SquareMat> addAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool) {
+    return pool.submit([a, b] { return a + b; });
+}
+
+std::future<SquareMat> subtractAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool) {
+    return pool.submit([a, b] { return a - b; });
+}
+
+std::future<SquareMat> powerAsync(const SquareMat& a, int k, ThreadPool& pool) {
+    return pool.submit([a, k] { return a ^ k; });
+}
+
+std::future<double> determinantAsync(const SquareMat& a, ThreadPool& pool) {
+    return pool.submit([a] { return !a; });
+}
+
+std::future<LogDeterminant> logDeterminantAsync(const SquareMat& a, ThreadPool& pool) {
+    return pool.submit([a] { return a.logDeterminant(); });
+}
+
+} // namespace matrix
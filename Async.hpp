@@ -0,0 +1,24 @@
+//agassinoa20@gmail.com
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include "SquareMat.hpp"
+#include "ThreadPool.hpp"
+#include <future>
+
+namespace matrix {
+
+// Asynchronous forms of the expensive operations. Each call takes O(1)
+// copy-on-write copies of its operands, so the caller may keep modifying or
+// destroy its own matrices while the task runs on the pool. Errors (such as a
+// size mismatch) are delivered by the future's get().
+std::future<SquareMat> multiplyAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool = ThreadPool::shared());
+std::future<SquareMat> addAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool = ThreadPool::shared());
+std::future<SquareMat> subtractAsync(const SquareMat& a, const SquareMat& b, ThreadPool& pool = ThreadPool::shared());
+std::future<SquareMat> powerAsync(const SquareMat& a, int k, ThreadPool& pool = ThreadPool::shared());
+std::future<double> determinantAsync(const SquareMat& a, ThreadPool& pool = ThreadPool::shared());
+std::future<LogDeterminant> logDeterminantAsync(const SquareMat& a, ThreadPool& pool = ThreadPool::shared());
+
+} // namespace matrix
+
+#endif // ASYNC_HPP
@@ -0,0 +1,119 @@
+//agassinoa20@gmail.com
+#include "Histogram.hpp"
+
+namespace matrix {
+namespace stats {
+
+/// @brief Position of the highest set bit (value must be non-zero)
+static int highestBit(std::uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+int LatencyHistogram::bucketIndex(std::uint64_t value) {
+    if (value > MAX_VALUE) {
+        value = MAX_VALUE;
+    }
+    if (value < 2 * SUB_COUNT) {
+        return static_cast<int>(value);
+    }
+    int shift = highestBit(value) - SUB_BITS;
+    return (shift + 1) * SUB_COUNT + static_cast<int>(value >> shift) - SUB_COUNT;
+}
+
+std::uint64_t LatencyHistogram::bucketLowest(int index) {
+    if (index < 2 * SUB_COUNT) {
+        return static_cast<std::uint64_t>(index);
+    }
+    int shift = index / SUB_COUNT - 1;
+    std::uint64_t sub = static_cast<std::uint64_t>(index % SUB_COUNT + SUB_COUNT);
+    return sub << shift;
+}
+
+std::uint64_t LatencyHistogram::bucketHighest(int index) {
+    if (index < 2 * SUB_COUNT) {
+        return static_cast<std::uint64_t>(index);
+    }
+    int shift = index / SUB_COUNT - 1;
+    return bucketLowest(index) + (std::uint64_t(1) << shift) - 1;
+}
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKETS, 0), total(0) {}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    ++counts[bucketIndex(value)];
+    ++total;
+}
+
+void LatencyHistogram::recordCount(int index, std::uint64_t count) {
+    counts[index] += count;
+    total += count;
+}
+
+LatencyHistogram& LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    return *this;
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] = 0;
+    }
+    total = 0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+    // rank of the sample we need, 1-based; at least the first sample
+    std::uint64_t rank = static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketHighest(i);
+        }
+    }
+    return max();
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return total;
+}
+
+std::uint64_t LatencyHistogram::min() const {
+    for (int i = 0; i < BUCKETS; ++i) {
+        if (counts[i] != 0) {
+            return bucketLowest(i);
+        }
+    }
+    return 0;
+}
+
+std::uint64_t LatencyHistogram::max() const {
+    for (int i = BUCKETS - 1; i >= 0; --i) {
+        if (counts[i] != 0) {
+            return bucketHighest(i);
+        }
+    }
+    return 0;
+}
+
+std::uint64_t LatencyHistogram::countAt(int index) const {
+    return counts[index];
+}
+
+} // namespace stats
+} // namespace matrix
@@ -0,0 +1,52 @@
+//agassinoa20@gmail.com
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace matrix {
+namespace stats {
+
+/// @brief HDR-style latency histogram over nanosecond values.
+/// Values below 64 get exact buckets; above that every power of two is split
+/// into 32 linear sub-buckets, so any recorded value is reproduced within about
+/// 3% while the whole range up to MAX_VALUE (about 18 minutes) needs only
+/// BUCKETS counters. Larger values are clamped to MAX_VALUE. min() and max()
+/// are bucket bounds, so they carry the same relative precision.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_BITS = 40;
+    static const std::uint64_t MAX_VALUE = (std::uint64_t(1) << MAX_BITS) - 1;
+    static const int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    static int bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketLowest(int index);
+    static std::uint64_t bucketHighest(int index);
+
+private:
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total;
+
+public:
+    LatencyHistogram();
+
+    void record(std::uint64_t value);
+    void recordCount(int index, std::uint64_t count);  // adds `count` hits to a raw bucket
+    LatencyHistogram& merge(const LatencyHistogram& other);
+    void reset();
+
+    /// @brief Highest value (bucket upper bound) at or below which `percentile`% of samples fall.
+    std::uint64_t percentile(double percentile) const;
+    std::uint64_t count() const;
+    std::uint64_t min() const;
+    std::uint64_t max() const;
+    std::uint64_t countAt(int index) const;
+};
+
+} // namespace stats
+} // namespace matrix
+
+#endif // HISTOGRAM_HPP
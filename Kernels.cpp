@@ -0,0 +1,293 @@
+//agassinoa20@gmail.com
+#include "Kernels.hpp"
+#include "Memory.hpp"
+#include "Parallel.hpp"
+#include "Stats.hpp"
+#include <cmath>
+
+namespace matrix {
+namespace detail {
+
+// Tile sizes: a KB x NB tile of B (128 x 256 doubles) stays resident in L2
+// while every row of A streams past it; TILE is used by the O(n^2) kernels.
+static const int KB = 128;
+static const int NB = 256;
+static const int TILE = 32;
+// LU panel width: the trailing update is a rank-PANEL gemm, wide enough to run
+// near gemm speed while the unblocked panel work stays a small fraction.
+static const int PANEL = 64;
+// Minimum multiply-adds a parallel chunk should carry to be worth a thread.
+static const long PARALLEL_WORK = 1L << 20;
+
+static int minInt(int a, int b) {
+    return a < b ? a : b;
+}
+
+/// @brief Chunk length so each chunk of rows/columns carries PARALLEL_WORK multiply-adds
+static int grainFor(long workPerItem) {
+    long grain = PARALLEL_WORK / (workPerItem > 0 ? workPerItem : 1) + 1;
+    return grain > (1L << 30) ? (1 << 30) : static_cast<int>(grain);
+}
+
+/// @brief C = beta * C (beta == 0 overwrites, so garbage or NaN in C is ignored)
+static void scaleOutput(int m, int n, double beta, double* c, int ldc) {
+    if (beta == 1.0) {
+        return;
+    }
+    for (int i = 0; i < m; ++i) {
+        double* cRow = c + i * ldc;
+        if (beta == 0.0) {
+            for (int j = 0; j < n; ++j) {
+                cRow[j] = 0.0;
+            }
+        } else {
+            for (int j = 0; j < n; ++j) {
+                cRow[j] *= beta;
+            }
+        }
+    }
+}
+
+/// @brief C += alpha * op(A) * B with B untransposed.
+/// Loop order i-p-j keeps the innermost loop contiguous in both B and C, so it
+/// vectorizes; op(A) only contributes one scalar per (i, p).
+static void gemmBlockedB(bool transA, int m, int n, int k, double alpha,
+                         const double* a, int lda, const double* b, int ldb,
+                         double* c, int ldc) {
+    for (int p0 = 0; p0 < k; p0 += KB) {
+        int pEnd = minInt(p0 + KB, k);
+        for (int j0 = 0; j0 < n; j0 += NB) {
+            int jEnd = minInt(j0 + NB, n);
+            for (int i = 0; i < m; ++i) {
+                double* cRow = c + i * ldc;
+                for (int p = p0; p < pEnd; ++p) {
+                    double aip = alpha * (transA ? a[p * lda + i] : a[i * lda + p]);
+                    const double* bRow = b + p * ldb;
+                    for (int j = j0; j < jEnd; ++j) {
+                        cRow[j] += aip * bRow[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief C += alpha * A * B^T: every entry is a dot product of two contiguous rows.
+static void gemmRowDots(int m, int n, int k, double alpha,
+                        const double* a, int lda, const double* b, int ldb,
+                        double* c, int ldc) {
+    for (int i = 0; i < m; ++i) {
+        const double* aRow = a + i * lda;
+        double* cRow = c + i * ldc;
+        for (int j = 0; j < n; ++j) {
+            const double* bRow = b + j * ldb;
+            double sum = 0.0;
+            for (int p = 0; p < k; ++p) {
+                sum += aRow[p] * bRow[p];
+            }
+            cRow[j] += alpha * sum;
+        }
+    }
+}
+
+void gemm(bool transA, bool transB, int m, int n, int k,
+          double alpha, const double* a, int lda,
+          const double* b, int ldb,
+          double beta, double* c, int ldc) {
+    scaleOutput(m, n, beta, c, ldc);
+    if (m <= 0 || n <= 0 || k <= 0 || alpha == 0.0) {
+        return;
+    }
+    if (!transB) {
+        SQUAREMAT_OP_ALGORITHM(transA ? "gemm-tn-blocked" : "gemm-nn-blocked");
+        gemmBlockedB(transA, m, n, k, alpha, a, lda, b, ldb, c, ldc);
+    } else if (!transA) {
+        SQUAREMAT_OP_ALGORITHM("gemm-nt-dot");
+        gemmRowDots(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+    } else {
+        // A^T * B^T: pack B^T once (k x n) and reuse the contiguous kernel
+        SQUAREMAT_OP_ALGORITHM("gemm-tt-packed");
+        // leased (not new[]) so it is accounted, budgeted and released on throw
+        memory::Scratch packedBuffer(4, static_cast<std::size_t>(k) * static_cast<std::size_t>(n));
+        double* packed = packedBuffer.data();
+        for (int p0 = 0; p0 < k; p0 += TILE) {
+            for (int j0 = 0; j0 < n; j0 += TILE) {
+                for (int j = j0; j < minInt(j0 + TILE, n); ++j) {
+                    for (int p = p0; p < minInt(p0 + TILE, k); ++p) {
+                        packed[p * n + j] = b[j * ldb + p];
+                    }
+                }
+            }
+        }
+        gemmBlockedB(true, m, n, k, alpha, a, lda, packed, n, c, ldc);
+    }
+}
+
+/// @brief Dot product with four independent accumulators, so the additions can
+/// overlap (and vectorize) without relying on -ffast-math reassociation
+static double dot(int k, const double* a, const double* b) {
+    double s0 = 0.0;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double s3 = 0.0;
+    int p = 0;
+    for (; p + 4 <= k; p += 4) {
+        s0 += a[p] * b[p];
+        s1 += a[p + 1] * b[p + 1];
+        s2 += a[p + 2] * b[p + 2];
+        s3 += a[p + 3] * b[p + 3];
+    }
+    for (; p < k; ++p) {
+        s0 += a[p] * b[p];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+void gemv(bool transA, int n, double alpha, const double* a, int lda,
+          const double* x, double beta, double* y) {
+    if (!transA) {
+        // one row dot per output element; rows split across threads
+        parallelFor(0, n, grainFor(n), [=](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) {
+                double value = alpha * dot(n, a + i * lda, x);
+                y[i] = beta == 0.0 ? value : value + beta * y[i];
+            }
+        });
+        return;
+    }
+    // y = A^T x is a sum of scaled rows of A: stream each row once into a
+    // contiguous slice of y; each thread owns a column range
+    parallelFor(0, n, grainFor(n), [=](int j0, int j1) {
+        for (int j = j0; j < j1; ++j) {
+            y[j] = beta == 0.0 ? 0.0 : beta * y[j];
+        }
+        for (int i = 0; i < n; ++i) {
+            double xi = alpha * x[i];
+            const double* aRow = a + i * lda;
+            for (int j = j0; j < j1; ++j) {
+                y[j] += xi * aRow[j];
+            }
+        }
+    });
+}
+
+void geadd(bool transA, bool transB, int n,
+           double alpha, const double* a, int lda,
+           double beta, const double* b, int ldb,
+           double* c, int ldc) {
+    for (int i0 = 0; i0 < n; i0 += TILE) {
+        int iEnd = minInt(i0 + TILE, n);
+        for (int j0 = 0; j0 < n; j0 += TILE) {
+            int jEnd = minInt(j0 + TILE, n);
+            for (int i = i0; i < iEnd; ++i) {
+                double* cRow = c + i * ldc;
+                for (int j = j0; j < jEnd; ++j) {
+                    double aij = transA ? a[j * lda + i] : a[i * lda + j];
+                    double bij = transB ? b[j * ldb + i] : b[i * ldb + j];
+                    cRow[j] = alpha * aij + beta * bij;
+                }
+            }
+        }
+    }
+}
+
+void transpose(int n, const double* a, int lda, double* b, int ldb) {
+    SQUAREMAT_OP_ALGORITHM("tiled-transpose");
+    // bands of TILE rows are independent; each element move counts as one unit of work
+    int bands = (n + TILE - 1) / TILE;
+    parallelFor(0, bands, grainFor(static_cast<long>(TILE) * n), [=](int band0, int band1) {
+        for (int i0 = band0 * TILE; i0 < minInt(band1 * TILE, n); i0 += TILE) {
+            int iEnd = minInt(i0 + TILE, n);
+            for (int j0 = 0; j0 < n; j0 += TILE) {
+                int jEnd = minInt(j0 + TILE, n);
+                for (int i = i0; i < iEnd; ++i) {
+                    for (int j = j0; j < jEnd; ++j) {
+                        b[j * ldb + i] = a[i * lda + j];
+                    }
+                }
+            }
+        }
+    });
+}
+
+/// @brief Unblocked factorization of columns [k0, kEnd) over rows [k0, n).
+/// Row swaps are applied to whole rows so the trailing columns stay consistent.
+static int factorPanel(int n, double* a, int lda, int k0, int kEnd) {
+    int sign = 1;
+    for (int j = k0; j < kEnd; ++j) {
+        int pivot = j;
+        double best = std::fabs(a[j * lda + j]);
+        for (int i = j + 1; i < n; ++i) {
+            double value = std::fabs(a[i * lda + j]);
+            if (value > best) {
+                best = value;
+                pivot = i;
+            }
+        }
+        if (best == 0.0) {
+            return 0;
+        }
+        if (pivot != j) {
+            double* rowJ = a + j * lda;
+            double* rowP = a + pivot * lda;
+            for (int c = 0; c < n; ++c) {
+                double tmp = rowJ[c];
+                rowJ[c] = rowP[c];
+                rowP[c] = tmp;
+            }
+            sign = -sign;
+        }
+        const double* pivotRow = a + j * lda;
+        double inverse = 1.0 / pivotRow[j];
+        for (int i = j + 1; i < n; ++i) {
+            double* row = a + i * lda;
+            double l = row[j] * inverse;
+            row[j] = l;
+            for (int c = j + 1; c < kEnd; ++c) {
+                row[c] -= l * pivotRow[c];
+            }
+        }
+    }
+    return sign;
+}
+
+int luFactor(int n, double* a, int lda) {
+    int sign = 1;
+    for (int k0 = 0; k0 < n; k0 += PANEL) {
+        int kEnd = minInt(k0 + PANEL, n);
+        int panelSign = factorPanel(n, a, lda, k0, kEnd);
+        if (panelSign == 0) {
+            return 0;
+        }
+        sign *= panelSign;
+        int rest = n - kEnd;
+        if (rest == 0) {
+            break;
+        }
+        int kb = kEnd - k0;
+
+        // U12 = L11^-1 * A12, split into independent column ranges
+        parallelFor(kEnd, n, grainFor(static_cast<long>(kb) * kb / 2), [=](int c0, int c1) {
+            for (int i = k0 + 1; i < kEnd; ++i) {
+                double* row = a + i * lda;
+                for (int p = k0; p < i; ++p) {
+                    double l = row[p];
+                    const double* upper = a + p * lda;
+                    for (int c = c0; c < c1; ++c) {
+                        row[c] -= l * upper[c];
+                    }
+                }
+            }
+        });
+
+        // A22 -= L21 * U12 through the shared gemm kernel, one band of rows per thread
+        parallelFor(kEnd, n, grainFor(static_cast<long>(rest) * kb), [=](int r0, int r1) {
+            gemm(false, false, r1 - r0, rest, kb, -1.0, a + r0 * lda + k0, lda,
+                 a + k0 * lda + kEnd, lda, 1.0, a + r0 * lda + kEnd, lda);
+        });
+    }
+    return sign;
+}
+
+} // namespace detail
+} // namespace matrix
@@ -0,0 +1,47 @@
+//agassinoa20@gmail.com
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+// Raw row-major kernels shared by SquareMat and its views.
+// Every operand is described by a pointer plus a leading dimension (the
+// distance between consecutive rows), and a transpose flag where it matters,
+// so callers never need to copy data into a particular layout first.
+
+namespace matrix {
+namespace detail {
+
+/// @brief C = alpha * op(A) * op(B) + beta * C, where C is m x n and the inner dimension is k.
+/// op(X) is X or X^T depending on the flag. C must not overlap A or B.
+/// When beta is 0, C is overwritten without being read.
+void gemm(bool transA, bool transB, int m, int n, int k,
+          double alpha, const double* a, int lda,
+          const double* b, int ldb,
+          double beta, double* c, int ldc);
+
+/// @brief y = alpha * op(A) * x + beta * y for an n x n block A and length-n
+/// vectors. y must not overlap A or x; beta 0 overwrites y without reading it.
+/// Large products are split across threads.
+void gemv(bool transA, int n, double alpha, const double* a, int lda,
+          const double* x, double beta, double* y);
+
+/// @brief C = alpha * op(A) + beta * op(B) for n x n operands.
+/// C may alias an operand only if that operand is not transposed.
+void geadd(bool transA, bool transB, int n,
+           double alpha, const double* a, int lda,
+           double beta, const double* b, int ldb,
+           double* c, int ldc);
+
+/// @brief B = A^T for an n x n block, tiled for cache reuse. A and B must not overlap.
+void transpose(int n, const double* a, int lda, double* b, int ldb);
+
+/// @brief In-place LU factorization with partial pivoting of an n x n block.
+/// On return the strict lower triangle holds the unit-lower factor L and the
+/// upper triangle holds U, for the row-permuted input. Returns the sign of the
+/// row permutation (+1 or -1), or 0 as soon as a zero pivot shows the matrix
+/// is singular (the block is then only partially factored).
+int luFactor(int n, double* a, int lda);
+
+} // namespace detail
+} // namespace matrix
+
+#endif // KERNELS_HPP
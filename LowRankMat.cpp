@@ -0,0 +1,339 @@
+//agassinoa20@gmail.com
+#include "LowRankMat.hpp"
+#include "Memory.hpp"
+#include "Stats.hpp"
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+namespace matrix {
+
+/// @brief Number of doubles in one n x k factor
+static std::size_t factorCells(int n, int k) {
+    return static_cast<std::size_t>(n) * static_cast<std::size_t>(k);
+}
+
+/// @brief Adds sign * U * V^T into the dense row-major n x n buffer dst.
+/// V is transposed into a k x n scratch first so the inner loop runs over
+/// contiguous memory; the n x n correction itself is never formed.
+static void addFactored(double* dst, int n, const double* u, const double* v, int k, double sign) {
+    SQUAREMAT_OP_ALGORITHM("low-rank-update");
+    memory::Scratch vtBuffer(5, factorCells(n, k));
+    double* vt = vtBuffer.data();
+    for (int j = 0; j < n; ++j) {
+        for (int r = 0; r < k; ++r) {
+            vt[r * n + j] = v[j * k + r];
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        double* dstRow = dst + i * n;
+        for (int r = 0; r < k; ++r) {
+            double coeff = sign * u[i * k + r];
+            const double* vtRow = vt + r * n;
+            for (int j = 0; j < n; ++j) {
+                dstRow[j] += coeff * vtRow[j];
+            }
+        }
+    }
+}
+
+/// @brief Constructor that initializes zero factors of the given rank
+LowRankMat::LowRankMat(int n, int k) : size(n), rank(k), u(nullptr), v(nullptr) {
+    if (n <= 0) {
+        throw MatrixException("matrix size must be positive");
+    }
+    if (k <= 0) {
+        throw MatrixException("matrix rank must be positive");
+    }
+    u = memory::allocate(factorCells(n, k));
+    try {
+        v = memory::allocate(factorCells(n, k));
+    } catch (...) {
+        memory::release(u, factorCells(n, k));
+        throw;
+    }
+    for (int i = 0; i < n * k; ++i) {
+        u[i] = 0.0;
+        v[i] = 0.0;
+    }
+}
+
+/// @brief Constructor that copies the provided row-major n x k factors
+LowRankMat::LowRankMat(int n, int k, const double* uData, const double* vData) : LowRankMat(n, k) {
+    for (int i = 0; i < n * k; ++i) {
+        u[i] = uData[i];
+        v[i] = vData[i];
+    }
+}
+
+/// @brief Copy constructor that performs deep copy
+LowRankMat::LowRankMat(const LowRankMat& other) : LowRankMat(other.size, other.rank) {
+    copyMem(other);
+}
+
+/// @brief Assignment operator: copies into fresh factors first and swaps them
+/// in, so a failed allocation leaves this matrix unchanged
+LowRankMat& LowRankMat::operator=(const LowRankMat& other) {
+    if (this != &other) {
+        if (size == other.size && rank == other.rank) {
+            copyMem(other);
+        } else {
+            LowRankMat copy(other);
+            swapFactors(copy);
+        }
+    }
+    return *this;
+}
+
+/// @brief Destructor to free factor memory
+LowRankMat::~LowRankMat() {
+    memory::release(u, factorCells(size, rank));
+    memory::release(v, factorCells(size, rank));
+}
+
+/// @brief Exchanges shape and factors with other
+void LowRankMat::swapFactors(LowRankMat& other) {
+    std::swap(size, other.size);
+    std::swap(rank, other.rank);
+    std::swap(u, other.u);
+    std::swap(v, other.v);
+}
+
+/// @brief Helper to copy factor contents
+void LowRankMat::copyMem(const LowRankMat& other) {
+    for (int i = 0; i < size * rank; ++i) {
+        u[i] = other.u[i];
+        v[i] = other.v[i];
+    }
+}
+
+/// @brief Unary minus: negates U only
+LowRankMat LowRankMat::operator-() const {
+    LowRankMat result(*this);
+    return result *= -1.0;
+}
+
+/// @brief Transpose: (U V^T)^T = V U^T, so the factors just swap
+LowRankMat LowRankMat::operator~() const {
+    return LowRankMat(size, rank, v, u);
+}
+
+/// @brief Low-rank addition: concatenates the factors, rank becomes k1 + k2
+LowRankMat& LowRankMat::operator+=(const LowRankMat& rhs) {
+    if (size != rhs.size) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    int newRank = rank + rhs.rank;
+    LowRankMat grown(size, newRank);
+    double* newU = grown.u;
+    double* newV = grown.v;
+    for (int i = 0; i < size; ++i) {
+        for (int r = 0; r < rank; ++r) {
+            newU[i * newRank + r] = u[i * rank + r];
+            newV[i * newRank + r] = v[i * rank + r];
+        }
+        for (int r = 0; r < rhs.rank; ++r) {
+            newU[i * newRank + rank + r] = rhs.u[i * rhs.rank + r];
+            newV[i * newRank + rank + r] = rhs.v[i * rhs.rank + r];
+        }
+    }
+    swapFactors(grown);
+    return *this;
+}
+
+/// @brief Low-rank subtraction: concatenates U with -U', rank becomes k1 + k2
+LowRankMat& LowRankMat::operator-=(const LowRankMat& rhs) {
+    return *this += -rhs;
+}
+
+/// @brief Scalar multiplication assignment (scales U only)
+LowRankMat& LowRankMat::operator*=(double scalar) {
+    for (int i = 0; i < size * rank; ++i) {
+        u[i] *= scalar;
+    }
+    return *this;
+}
+
+double* LowRankMat::getU() {
+    return u;
+}
+
+const double* LowRankMat::getU() const {
+    return u;
+}
+
+double* LowRankMat::getV() {
+    return v;
+}
+
+const double* LowRankMat::getV() const {
+    return v;
+}
+
+/// @brief Materializes U * V^T as a dense matrix
+SquareMat LowRankMat::toDense() const {
+    SquareMat result(size);
+    addFactored(result.data(), size, u, v, rank, 1.0);
+    return result;
+}
+
+/// @brief Returns the matrix size
+int LowRankMat::getSize() const {
+    return size;
+}
+
+/// @brief Returns the number of columns in U and V
+int LowRankMat::getRank() const {
+    return rank;
+}
+
+/// @brief Output stream operator (prints the dense form)
+std::ostream& operator<<(std::ostream& os, const LowRankMat& mat) {
+    return os << mat.toDense();
+}
+
+/// @brief Dense += low-rank: A += U V^T in O(n^2 k)
+SquareMat& SquareMat::operator+=(const LowRankMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Add, size, 2 * static_cast<std::uint64_t>(size) * size * rhs.getRank(), sizeof(double) * 2 * static_cast<std::uint64_t>(size) * size);
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    prepareWrite();
+    addFactored(matrix, size, rhs.getU(), rhs.getV(), rhs.getRank(), 1.0);
+    return *this;
+}
+
+/// @brief Dense -= low-rank: A -= U V^T in O(n^2 k)
+SquareMat& SquareMat::operator-=(const LowRankMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Subtract, size, 2 * static_cast<std::uint64_t>(size) * size * rhs.getRank(), sizeof(double) * 2 * static_cast<std::uint64_t>(size) * size);
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    prepareWrite();
+    addFactored(matrix, size, rhs.getU(), rhs.getV(), rhs.getRank(), -1.0);
+    return *this;
+}
+
+/// @brief External operator+: lhs + rhs (factor concatenation)
+LowRankMat operator+(const LowRankMat& lhs, const LowRankMat& rhs) {
+    return LowRankMat(lhs) += rhs;
+}
+
+/// @brief External operator-: lhs - rhs (factor concatenation)
+LowRankMat operator-(const LowRankMat& lhs, const LowRankMat& rhs) {
+    return LowRankMat(lhs) -= rhs;
+}
+
+/// @brief External operator*: low-rank * scalar
+LowRankMat operator*(const LowRankMat& mat, double scalar) {
+    return LowRankMat(mat) *= scalar;
+}
+
+/// @brief External operator*: scalar * low-rank
+LowRankMat operator*(double scalar, const LowRankMat& mat) {
+    return mat * scalar;
+}
+
+/// @brief External operator*: A * (U V^T) = (A U) V^T
+LowRankMat operator*(const SquareMat& lhs, const LowRankMat& rhs) {
+    int n = rhs.size;
+    int k = rhs.rank;
+    if (lhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    const double* denseA = lhs.data();
+    LowRankMat result(n, k);
+    for (int i = 0; i < n; ++i) {
+        double* outRow = result.u + i * k;
+        for (int j = 0; j < n; ++j) {
+            double a = denseA[i * n + j];
+            const double* uRow = rhs.u + j * k;
+            for (int r = 0; r < k; ++r) {
+                outRow[r] += a * uRow[r];
+            }
+        }
+    }
+    for (int i = 0; i < n * k; ++i) {
+        result.v[i] = rhs.v[i];
+    }
+    return result;
+}
+
+/// @brief External operator*: (U V^T) * A = U (A^T V)^T
+LowRankMat operator*(const LowRankMat& lhs, const SquareMat& rhs) {
+    int n = lhs.size;
+    int k = lhs.rank;
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    const double* denseA = rhs.data();
+    LowRankMat result(n, k);
+    for (int i = 0; i < n; ++i) {
+        const double* vRow = lhs.v + i * k;
+        for (int j = 0; j < n; ++j) {
+            double a = denseA[i * n + j];
+            double* outRow = result.v + j * k;
+            for (int r = 0; r < k; ++r) {
+                outRow[r] += a * vRow[r];
+            }
+        }
+    }
+    for (int i = 0; i < n * k; ++i) {
+        result.u[i] = lhs.u[i];
+    }
+    return result;
+}
+
+/// @brief External operator*: (U1 V1^T)(U2 V2^T) = (U1 (V1^T U2)) V2^T, rank k2
+LowRankMat operator*(const LowRankMat& lhs, const LowRankMat& rhs) {
+    int n = lhs.size;
+    if (rhs.size != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    int k1 = lhs.rank;
+    int k2 = rhs.rank;
+    // core = V1^T U2 is only k1 x k2
+    memory::Scratch coreBuffer(5, factorCells(k1, k2));
+    double* core = coreBuffer.data();
+    for (int i = 0; i < k1 * k2; ++i) {
+        core[i] = 0.0;
+    }
+    for (int i = 0; i < n; ++i) {
+        for (int a = 0; a < k1; ++a) {
+            double vVal = lhs.v[i * k1 + a];
+            for (int b = 0; b < k2; ++b) {
+                core[a * k2 + b] += vVal * rhs.u[i * k2 + b];
+            }
+        }
+    }
+    LowRankMat result(n, k2);
+    for (int i = 0; i < n; ++i) {
+        for (int a = 0; a < k1; ++a) {
+            double uVal = lhs.u[i * k1 + a];
+            for (int b = 0; b < k2; ++b) {
+                result.u[i * k2 + b] += uVal * core[a * k2 + b];
+            }
+        }
+    }
+    for (int i = 0; i < n * k2; ++i) {
+        result.v[i] = rhs.v[i];
+    }
+    return result;
+}
+
+/// @brief External operator+: dense + low-rank
+SquareMat operator+(const SquareMat& lhs, const LowRankMat& rhs) {
+    return SquareMat(lhs) += rhs;
+}
+
+/// @brief External operator+: low-rank + dense
+SquareMat operator+(const LowRankMat& lhs, const SquareMat& rhs) {
+    return SquareMat(rhs) += lhs;
+}
+
+/// @brief External operator-: dense - low-rank
+SquareMat operator-(const SquareMat& lhs, const LowRankMat& rhs) {
+    return SquareMat(lhs) -= rhs;
+}
+
+} // namespace matrix
@@ -0,0 +1,77 @@
+//agassinoa20@gmail.com
+#ifndef LOWRANKMAT_HPP
+#define LOWRANKMAT_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+/// @brief Rank-k matrix stored in factored form U * V^T.
+/// U and V are both size x rank and stored row-major, so a correction of
+/// rank k costs 2nk doubles instead of n^2. Factors and temporaries come from
+/// the memory layer and count against its budget.
+class LowRankMat {
+private:
+    int size;
+    int rank;
+    double* u;
+    double* v;
+
+    void copyMem(const LowRankMat& other);
+    void swapFactors(LowRankMat& other);
+
+    friend LowRankMat operator*(const SquareMat& lhs, const LowRankMat& rhs);
+    friend LowRankMat operator*(const LowRankMat& lhs, const SquareMat& rhs);
+    friend LowRankMat operator*(const LowRankMat& lhs, const LowRankMat& rhs);
+
+public:
+
+    // Constructor and Destructor
+    LowRankMat(int n, int k);
+    LowRankMat(int n, int k, const double* uData, const double* vData);
+    LowRankMat(const LowRankMat& other);
+    LowRankMat& operator=(const LowRankMat& other);
+    ~LowRankMat();
+
+    // Unary
+    LowRankMat operator-() const;
+    LowRankMat operator~() const;
+
+    // Compound assignment
+    LowRankMat& operator+=(const LowRankMat& rhs);
+    LowRankMat& operator-=(const LowRankMat& rhs);
+    LowRankMat& operator*=(double scalar);
+
+    // Factor access (row-major, size x rank)
+    double* getU();
+    const double* getU() const;
+    double* getV();
+    const double* getV() const;
+
+    SquareMat toDense() const;
+    int getSize() const;
+    int getRank() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const LowRankMat& mat);
+};
+
+// Low-rank arithmetic (rank of a sum is the sum of the ranks)
+LowRankMat operator+(const LowRankMat& lhs, const LowRankMat& rhs);
+LowRankMat operator-(const LowRankMat& lhs, const LowRankMat& rhs);
+LowRankMat operator*(const LowRankMat& mat, double scalar);
+LowRankMat operator*(double scalar, const LowRankMat& mat);
+
+// Products stay in factored form and cost O(n^2 k)
+LowRankMat operator*(const SquareMat& lhs, const LowRankMat& rhs);
+LowRankMat operator*(const LowRankMat& lhs, const SquareMat& rhs);
+LowRankMat operator*(const LowRankMat& lhs, const LowRankMat& rhs);
+
+// Dense updates, applied without materializing U * V^T
+SquareMat operator+(const SquareMat& lhs, const LowRankMat& rhs);
+SquareMat operator+(const LowRankMat& lhs, const SquareMat& rhs);
+SquareMat operator-(const SquareMat& lhs, const LowRankMat& rhs);
+
+} // namespace matrix
+
+#endif // LOWRANKMAT_HPP
@@ -0,0 +1,189 @@
+//agassinoa20@gmail.com
+#ifndef MATRIXITERATORS_HPP
+#define MATRIXITERATORS_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+// Iterator and range types behind SquareMat::begin/end, rows() and columns().
+// Element iteration uses plain pointers (contiguous, so the parallel STL can
+// vectorize it); rows are std::spans; columns use a strided random-access
+// iterator so they also work with std::execution policies.
+
+namespace matrix {
+
+/// @brief Random-access iterator over elements spaced `stride` doubles apart.
+template <typename T>
+class StrideIterator {
+private:
+    T* ptr;
+    std::ptrdiff_t stride;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    StrideIterator() : ptr(nullptr), stride(1) {}
+    StrideIterator(T* p, std::ptrdiff_t step) : ptr(p), stride(step) {}
+
+    reference operator*() const { return *ptr; }
+    pointer operator->() const { return ptr; }
+    reference operator[](difference_type n) const { return ptr[n * stride]; }
+
+    StrideIterator& operator++() { ptr += stride; return *this; }
+    StrideIterator operator++(int) { StrideIterator old(*this); ptr += stride; return old; }
+    StrideIterator& operator--() { ptr -= stride; return *this; }
+    StrideIterator operator--(int) { StrideIterator old(*this); ptr -= stride; return old; }
+    StrideIterator& operator+=(difference_type n) { ptr += n * stride; return *this; }
+    StrideIterator& operator-=(difference_type n) { ptr -= n * stride; return *this; }
+
+    friend StrideIterator operator+(StrideIterator it, difference_type n) { return it += n; }
+    friend StrideIterator operator+(difference_type n, StrideIterator it) { return it += n; }
+    friend StrideIterator operator-(StrideIterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const StrideIterator& a, const StrideIterator& b) {
+        return (a.ptr - b.ptr) / a.stride;
+    }
+
+    friend bool operator==(const StrideIterator& a, const StrideIterator& b) { return a.ptr == b.ptr; }
+    friend bool operator!=(const StrideIterator& a, const StrideIterator& b) { return a.ptr != b.ptr; }
+    friend bool operator<(const StrideIterator& a, const StrideIterator& b) { return a.ptr < b.ptr; }
+    friend bool operator>(const StrideIterator& a, const StrideIterator& b) { return a.ptr > b.ptr; }
+    friend bool operator<=(const StrideIterator& a, const StrideIterator& b) { return a.ptr <= b.ptr; }
+    friend bool operator>=(const StrideIterator& a, const StrideIterator& b) { return a.ptr >= b.ptr; }
+};
+
+/// @brief One column of a matrix: `count` elements spaced `stride` apart.
+template <typename T>
+class StridedRange {
+private:
+    T* first;
+    int count;
+    int stride;
+
+public:
+    using iterator = StrideIterator<T>;
+
+    StridedRange(T* data, int n, int step) : first(data), count(n), stride(step) {}
+
+    iterator begin() const { return iterator(first, stride); }
+    iterator end() const { return iterator(first + static_cast<std::ptrdiff_t>(count) * stride, stride); }
+    T& operator[](int i) const { return first[static_cast<std::ptrdiff_t>(i) * stride]; }
+    int size() const { return count; }
+};
+
+/// @brief Range over the rows of an n x n row-major buffer; each row is a std::span.
+template <typename T>
+class RowRange {
+private:
+    T* data;
+    int n;
+
+public:
+    class iterator {
+    private:
+        T* ptr;
+        int n;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::span<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::span<T>;
+
+        iterator() : ptr(nullptr), n(1) {}
+        iterator(T* p, int cols) : ptr(p), n(cols) {}
+
+        reference operator*() const { return std::span<T>(ptr, n); }
+        reference operator[](difference_type k) const { return std::span<T>(ptr + k * n, n); }
+
+        iterator& operator++() { ptr += n; return *this; }
+        iterator operator++(int) { iterator old(*this); ptr += n; return old; }
+        iterator& operator--() { ptr -= n; return *this; }
+        iterator operator--(int) { iterator old(*this); ptr -= n; return old; }
+        iterator& operator+=(difference_type k) { ptr += k * n; return *this; }
+        iterator& operator-=(difference_type k) { ptr -= k * n; return *this; }
+
+        friend iterator operator+(iterator it, difference_type k) { return it += k; }
+        friend iterator operator+(difference_type k, iterator it) { return it += k; }
+        friend iterator operator-(iterator it, difference_type k) { return it -= k; }
+        friend difference_type operator-(const iterator& a, const iterator& b) { return (a.ptr - b.ptr) / a.n; }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.ptr == b.ptr; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return a.ptr != b.ptr; }
+        friend bool operator<(const iterator& a, const iterator& b) { return a.ptr < b.ptr; }
+        friend bool operator>(const iterator& a, const iterator& b) { return a.ptr > b.ptr; }
+        friend bool operator<=(const iterator& a, const iterator& b) { return a.ptr <= b.ptr; }
+        friend bool operator>=(const iterator& a, const iterator& b) { return a.ptr >= b.ptr; }
+    };
+
+    RowRange(T* buffer, int size) : data(buffer), n(size) {}
+
+    iterator begin() const { return iterator(data, n); }
+    iterator end() const { return iterator(data + static_cast<std::ptrdiff_t>(n) * n, n); }
+    std::span<T> operator[](int i) const { return std::span<T>(data + static_cast<std::ptrdiff_t>(i) * n, n); }
+    int size() const { return n; }
+};
+
+/// @brief Range over the columns of an n x n row-major buffer; each column is a StridedRange.
+template <typename T>
+class ColumnRange {
+private:
+    T* data;
+    int n;
+
+public:
+    class iterator {
+    private:
+        T* ptr;
+        int n;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = StridedRange<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = StridedRange<T>;
+
+        iterator() : ptr(nullptr), n(1) {}
+        iterator(T* p, int size) : ptr(p), n(size) {}
+
+        reference operator*() const { return StridedRange<T>(ptr, n, n); }
+        reference operator[](difference_type k) const { return StridedRange<T>(ptr + k, n, n); }
+
+        iterator& operator++() { ++ptr; return *this; }
+        iterator operator++(int) { iterator old(*this); ++ptr; return old; }
+        iterator& operator--() { --ptr; return *this; }
+        iterator operator--(int) { iterator old(*this); --ptr; return old; }
+        iterator& operator+=(difference_type k) { ptr += k; return *this; }
+        iterator& operator-=(difference_type k) { ptr -= k; return *this; }
+
+        friend iterator operator+(iterator it, difference_type k) { return it += k; }
+        friend iterator operator+(difference_type k, iterator it) { return it += k; }
+        friend iterator operator-(iterator it, difference_type k) { return it -= k; }
+        friend difference_type operator-(const iterator& a, const iterator& b) { return a.ptr - b.ptr; }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.ptr == b.ptr; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return a.ptr != b.ptr; }
+        friend bool operator<(const iterator& a, const iterator& b) { return a.ptr < b.ptr; }
+        friend bool operator>(const iterator& a, const iterator& b) { return a.ptr > b.ptr; }
+        friend bool operator<=(const iterator& a, const iterator& b) { return a.ptr <= b.ptr; }
+        friend bool operator>=(const iterator& a, const iterator& b) { return a.ptr >= b.ptr; }
+    };
+
+    ColumnRange(T* buffer, int size) : data(buffer), n(size) {}
+
+    iterator begin() const { return iterator(data, n); }
+    iterator end() const { return iterator(data + n, n); }
+    StridedRange<T> operator[](int j) const { return StridedRange<T>(data + j, n, n); }
+    int size() const { return n; }
+};
+
+} // namespace matrix
+
+#endif // MATRIXITERATORS_HPP
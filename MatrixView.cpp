@@ -0,0 +1,291 @@
+//agassinoa20@gmail.com
+#include "MatrixView.hpp"
+#include "Kernels.hpp"
+#include "Stats.hpp"
+#include <cstdint>
+#include <iostream>
+
+namespace matrix {
+
+/// @brief True when the memory spanned by the two blocks can overlap
+static bool mayOverlap(const double* a, int aSize, int aStride, const double* b, int bSize, int bStride) {
+    const double* aEnd = a + (aSize - 1) * aStride + aSize;
+    const double* bEnd = b + (bSize - 1) * bStride + bSize;
+    return a < bEnd && b < aEnd;
+}
+
+/// @brief Constructor for a read-only view; stride is the distance between rows
+ConstMatrixView::ConstMatrixView(const double* data, int size, int stride, bool transposed)
+    : data(data), size(size), stride(stride), transposed(transposed) {
+    if (size <= 0) {
+        throw MatrixException("matrix size must be positive");
+    }
+    if (stride < size) {
+        throw MatrixException("view stride must be at least the view size");
+    }
+}
+
+// Implementation of ConstMatrixView's row proxy
+const double& ConstMatrixView::ConstRow::operator[](int col) const {
+    if (col < 0) {
+        throw MatrixException("Column index cannot be negative");
+    }
+    return rowData[col * step];
+}
+
+/// @brief Row access; a transposed view walks a column of the storage
+ConstMatrixView::ConstRow ConstMatrixView::operator[](int row) const {
+    if (row < 0 || row >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+    return transposed ? ConstRow(data + row, stride) : ConstRow(data + row * stride, 1);
+}
+
+/// @brief n x n sub-block starting at (row, col) in view coordinates
+ConstMatrixView ConstMatrixView::block(int row, int col, int n) const {
+    if (row < 0 || col < 0 || n <= 0 || row + n > size || col + n > size) {
+        throw MatrixException("Block out of bounds");
+    }
+    const double* origin = transposed ? data + col * stride + row : data + row * stride + col;
+    return ConstMatrixView(origin, n, stride, transposed);
+}
+
+/// @brief Transposed view of the same block
+ConstMatrixView ConstMatrixView::operator~() const {
+    return ConstMatrixView(data, size, stride, !transposed);
+}
+
+const double* ConstMatrixView::getData() const {
+    return data;
+}
+
+/// @brief Returns the view size
+int ConstMatrixView::getSize() const {
+    return size;
+}
+
+/// @brief Returns the distance between consecutive storage rows
+int ConstMatrixView::getStride() const {
+    return stride;
+}
+
+bool ConstMatrixView::isTransposed() const {
+    return transposed;
+}
+
+/// @brief Sums all elements in the block
+double ConstMatrixView::sum() const {
+    double total = 0.0;
+    for (int i = 0; i < size; ++i) {
+        const double* row = data + i * stride;
+        for (int j = 0; j < size; ++j) {
+            total += row[j];
+        }
+    }
+    return total;
+}
+
+/// @brief Output stream operator
+std::ostream& operator<<(std::ostream& os, const ConstMatrixView& view) {
+    for (int i = 0; i < view.size; ++i) {
+        for (int j = 0; j < view.size; ++j) {
+            os << view[i][j] << " ";
+        }
+        os << '\n';
+    }
+    return os;
+}
+
+/// @brief Constructor for a mutable view; stride is the distance between rows
+MatrixView::MatrixView(double* data, int size, int stride) : data(data), size(size), stride(stride) {
+    if (size <= 0) {
+        throw MatrixException("matrix size must be positive");
+    }
+    if (stride < size) {
+        throw MatrixException("view stride must be at least the view size");
+    }
+}
+
+/// @brief Row access through the same proxy SquareMat uses
+SquareMat::Row MatrixView::operator[](int row) const {
+    if (row < 0 || row >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+    return SquareMat::Row(data + row * stride, size);
+}
+
+/// @brief n x n sub-block starting at (row, col)
+MatrixView MatrixView::block(int row, int col, int n) const {
+    if (row < 0 || col < 0 || n <= 0 || row + n > size || col + n > size) {
+        throw MatrixException("Block out of bounds");
+    }
+    return MatrixView(data + row * stride + col, n, stride);
+}
+
+/// @brief Read-only transposed view of the same block
+ConstMatrixView MatrixView::operator~() const {
+    return ConstMatrixView(data, size, stride, true);
+}
+
+MatrixView::operator ConstMatrixView() const {
+    return ConstMatrixView(data, size, stride);
+}
+
+/// @brief Copies src element-wise into the viewed block
+MatrixView& MatrixView::assign(const ConstMatrixView& src) {
+    if (size != src.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for assignment");
+    }
+    if (mayOverlap(data, size, stride, src.getData(), src.getSize(), src.getStride())) {
+        if (src.getData() == data && src.getStride() == stride && !src.isTransposed()) {
+            return *this;
+        }
+        SquareMat copy(src);
+        return assign(copy);
+    }
+    if (src.isTransposed()) {
+        detail::transpose(size, src.getData(), src.getStride(), data, stride);
+    } else {
+        for (int i = 0; i < size; ++i) {
+            const double* srcRow = src.getData() + i * src.getStride();
+            double* dstRow = data + i * stride;
+            for (int j = 0; j < size; ++j) {
+                dstRow[j] = srcRow[j];
+            }
+        }
+    }
+    return *this;
+}
+
+/// @brief Element-wise addition into the viewed block
+MatrixView& MatrixView::operator+=(const ConstMatrixView& rhs) {
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    bool inPlaceSafe = rhs.getData() == data && rhs.getStride() == stride && !rhs.isTransposed();
+    if (!inPlaceSafe && mayOverlap(data, size, stride, rhs.getData(), rhs.getSize(), rhs.getStride())) {
+        SquareMat copy(rhs);
+        return *this += copy;
+    }
+    detail::geadd(false, rhs.isTransposed(), size, 1.0, data, stride, 1.0, rhs.getData(), rhs.getStride(), data, stride);
+    return *this;
+}
+
+/// @brief Element-wise subtraction into the viewed block
+MatrixView& MatrixView::operator-=(const ConstMatrixView& rhs) {
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    bool inPlaceSafe = rhs.getData() == data && rhs.getStride() == stride && !rhs.isTransposed();
+    if (!inPlaceSafe && mayOverlap(data, size, stride, rhs.getData(), rhs.getSize(), rhs.getStride())) {
+        SquareMat copy(rhs);
+        return *this -= copy;
+    }
+    detail::geadd(false, rhs.isTransposed(), size, 1.0, data, stride, -1.0, rhs.getData(), rhs.getStride(), data, stride);
+    return *this;
+}
+
+/// @brief Block multiplication assignment: block = block * rhs
+MatrixView& MatrixView::operator*=(const ConstMatrixView& rhs) {
+    return assign(*this * rhs);
+}
+
+/// @brief Scalar multiplication of the viewed block
+MatrixView& MatrixView::operator*=(double scalar) {
+    for (int i = 0; i < size; ++i) {
+        double* row = data + i * stride;
+        for (int j = 0; j < size; ++j) {
+            row[j] *= scalar;
+        }
+    }
+    return *this;
+}
+
+/// @brief Scalar division of the viewed block
+MatrixView& MatrixView::operator/=(double scalar) {
+    if (scalar == 0.0) {
+        throw MatrixException("Division by zero");
+    }
+    for (int i = 0; i < size; ++i) {
+        double* row = data + i * stride;
+        for (int j = 0; j < size; ++j) {
+            row[j] /= scalar;
+        }
+    }
+    return *this;
+}
+
+double* MatrixView::getData() const {
+    return data;
+}
+
+/// @brief Returns the view size
+int MatrixView::getSize() const {
+    return size;
+}
+
+/// @brief Returns the distance between consecutive storage rows
+int MatrixView::getStride() const {
+    return stride;
+}
+
+/// @brief Sums all elements in the block
+double MatrixView::sum() const {
+    return ConstMatrixView(*this).sum();
+}
+
+/// @brief Output stream operator
+std::ostream& operator<<(std::ostream& os, const MatrixView& view) {
+    return os << ConstMatrixView(view);
+}
+
+/// @brief External operator+: element-wise sum of two views
+SquareMat operator+(const ConstMatrixView& lhs, const ConstMatrixView& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Add, n, static_cast<std::uint64_t>(n) * n, sizeof(double) * 3 * static_cast<std::uint64_t>(n) * n);
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    SquareMat result(n);
+    detail::geadd(lhs.isTransposed(), rhs.isTransposed(), n, 1.0, lhs.getData(), lhs.getStride(),
+                  1.0, rhs.getData(), rhs.getStride(), result.view().getData(), n);
+    return result;
+}
+
+/// @brief External operator-: element-wise difference of two views
+SquareMat operator-(const ConstMatrixView& lhs, const ConstMatrixView& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Subtract, n, static_cast<std::uint64_t>(n) * n, sizeof(double) * 3 * static_cast<std::uint64_t>(n) * n);
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    SquareMat result(n);
+    detail::geadd(lhs.isTransposed(), rhs.isTransposed(), n, 1.0, lhs.getData(), lhs.getStride(),
+                  -1.0, rhs.getData(), rhs.getStride(), result.view().getData(), n);
+    return result;
+}
+
+/// @brief External operator*: matrix product of two views, read in place
+SquareMat operator*(const ConstMatrixView& lhs, const ConstMatrixView& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * static_cast<std::uint64_t>(n) * n * n, sizeof(double) * 3 * static_cast<std::uint64_t>(n) * n);
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    SquareMat result(n);
+    detail::gemm(lhs.isTransposed(), rhs.isTransposed(), n, n, n, 1.0, lhs.getData(), lhs.getStride(),
+                 rhs.getData(), rhs.getStride(), 0.0, result.view().getData(), n);
+    return result;
+}
+
+/// @brief External operator*: view * scalar
+SquareMat operator*(const ConstMatrixView& view, double scalar) {
+    return SquareMat(view) *= scalar;
+}
+
+/// @brief External operator*: scalar * view
+SquareMat operator*(double scalar, const ConstMatrixView& view) {
+    return view * scalar;
+}
+
+} // namespace matrix
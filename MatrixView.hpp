@@ -0,0 +1,89 @@
+//agassinoa20@gmail.com
+#ifndef MATRIXVIEW_HPP
+#define MATRIXVIEW_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+
+namespace matrix {
+
+/// @brief Read-only, non-owning view of a square block inside row-major storage.
+/// Element (i, j) lives at data[i * stride + j], or data[j * stride + i] when
+/// the view is transposed. Views never allocate and must not outlive the
+/// storage they point into.
+class ConstMatrixView {
+private:
+    const double* data;
+    int size;
+    int stride;
+    bool transposed;
+
+public:
+    ConstMatrixView(const double* data, int size, int stride, bool transposed = false);
+
+    class ConstRow {
+        private:
+            const double* rowData;
+            int step;
+        public:
+            ConstRow(const double* data, int step) : rowData(data), step(step) {}
+            const double& operator[](int col) const;
+        };
+
+    ConstRow operator[](int row) const;
+    ConstMatrixView block(int row, int col, int n) const;
+    ConstMatrixView operator~() const;  // O(1): flips the layout flag
+
+    const double* getData() const;
+    int getSize() const;
+    int getStride() const;
+    bool isTransposed() const;
+    double sum() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const ConstMatrixView& view);
+};
+
+/// @brief Mutable, non-owning view of a square block inside row-major storage.
+/// Compound assignments write straight into the viewed block, so blocked
+/// algorithms can update tiles of a larger SquareMat in place.
+class MatrixView {
+private:
+    double* data;
+    int size;
+    int stride;
+
+public:
+    MatrixView(double* data, int size, int stride);
+
+    SquareMat::Row operator[](int row) const;
+    MatrixView block(int row, int col, int n) const;
+    ConstMatrixView operator~() const;
+    operator ConstMatrixView() const;
+
+    // Element-wise writes into the viewed block
+    MatrixView& assign(const ConstMatrixView& src);
+    MatrixView& operator+=(const ConstMatrixView& rhs);
+    MatrixView& operator-=(const ConstMatrixView& rhs);
+    MatrixView& operator*=(const ConstMatrixView& rhs);
+    MatrixView& operator*=(double scalar);
+    MatrixView& operator/=(double scalar);
+
+    double* getData() const;
+    int getSize() const;
+    int getStride() const;
+    double sum() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const MatrixView& view);
+};
+
+// Binary operators on views; SquareMat and TransposedMat convert to ConstMatrixView,
+// so mixed expressions such as `a.block(0, 0, 2) * b` work without copying operands.
+SquareMat operator+(const ConstMatrixView& lhs, const ConstMatrixView& rhs);
+SquareMat operator-(const ConstMatrixView& lhs, const ConstMatrixView& rhs);
+SquareMat operator*(const ConstMatrixView& lhs, const ConstMatrixView& rhs);
+SquareMat operator*(const ConstMatrixView& view, double scalar);
+SquareMat operator*(double scalar, const ConstMatrixView& view);
+
+} // namespace matrix
+
+#endif // MATRIXVIEW_HPP
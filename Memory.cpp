@@ -0,0 +1,149 @@
+//agassinoa20@gmail.com
+#include "Memory.hpp"
+#include "SquareMat.hpp"
+#include <atomic>
+#include <new>
+
+namespace matrix {
+namespace memory {
+
+// Every counter is a relaxed atomic: allocations happen on any thread and a
+// usage() snapshot only needs each field to be individually consistent.
+static std::atomic<std::uint64_t> liveBytes{0};
+static std::atomic<std::uint64_t> peakBytes{0};
+static std::atomic<std::uint64_t> allocations{0};
+static std::atomic<std::uint64_t> releases{0};
+static std::atomic<std::uint64_t> rejected{0};
+static std::atomic<std::uint64_t> budgetBytes{0};
+static std::atomic<std::uint64_t> sizeHistogram[SIZE_CLASSES];
+
+/// @brief Smallest c with bytes <= 2^c, clamped to the last class
+int sizeClass(std::size_t bytes) {
+    int c = 0;
+    while (c < SIZE_CLASSES - 1 && (std::uint64_t(1) << c) < bytes) {
+        ++c;
+    }
+    return c;
+}
+
+static void raisePeak(std::uint64_t live) {
+    std::uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+double* allocate(std::size_t elements) {
+    std::uint64_t bytes = static_cast<std::uint64_t>(elements) * sizeof(double);
+    // reserve first so concurrent allocations cannot overshoot the budget together
+    std::uint64_t live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::uint64_t limit = budgetBytes.load(std::memory_order_relaxed);
+    if (limit != 0 && live > limit) {
+        liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        throw MatrixException("matrix memory budget exceeded");
+    }
+    double* data = new (std::nothrow) double[elements];
+    if (data == nullptr) {
+        liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        throw MatrixException("matrix allocation failed");
+    }
+    raisePeak(live);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    sizeHistogram[sizeClass(bytes)].fetch_add(1, std::memory_order_relaxed);
+    return data;
+}
+
+void release(double* data, std::size_t elements) {
+    if (data == nullptr) {
+        return;
+    }
+    delete[] data;
+    liveBytes.fetch_sub(static_cast<std::uint64_t>(elements) * sizeof(double), std::memory_order_relaxed);
+    releases.fetch_add(1, std::memory_order_relaxed);
+}
+
+void setBudget(std::uint64_t bytes) {
+    budgetBytes.store(bytes, std::memory_order_relaxed);
+}
+
+std::uint64_t budget() {
+    return budgetBytes.load(std::memory_order_relaxed);
+}
+
+Usage usage() {
+    Usage result;
+    result.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    result.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    result.allocations = allocations.load(std::memory_order_relaxed);
+    result.releases = releases.load(std::memory_order_relaxed);
+    result.rejected = rejected.load(std::memory_order_relaxed);
+    for (int c = 0; c < SIZE_CLASSES; ++c) {
+        result.sizeHistogram[c] = sizeHistogram[c].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void resetPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+static std::atomic<std::uint64_t> retentionBytes{std::uint64_t(1) << 22};
+
+/// @brief The calling thread's retained scratch, released when the thread exits
+struct ThreadScratch {
+    double* buffers[SCRATCH_SLOTS] = {};
+    std::size_t capacity[SCRATCH_SLOTS] = {};
+
+    void drop(int slot) {
+        release(buffers[slot], capacity[slot]);
+        buffers[slot] = nullptr;
+        capacity[slot] = 0;
+    }
+
+    ~ThreadScratch() {
+        for (int slot = 0; slot < SCRATCH_SLOTS; ++slot) {
+            drop(slot);
+        }
+    }
+};
+
+static ThreadScratch& threadScratch() {
+    static thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+Scratch::Scratch(int slot, std::size_t elements) : slot(slot), buffer(nullptr) {
+    ThreadScratch& scratch = threadScratch();
+    if (scratch.capacity[slot] < elements) {
+        scratch.drop(slot);  // before allocating, so the old buffer does not count twice
+        scratch.buffers[slot] = allocate(elements);
+        scratch.capacity[slot] = elements;
+    }
+    buffer = scratch.buffers[slot];
+}
+
+Scratch::~Scratch() {
+    ThreadScratch& scratch = threadScratch();
+    if (scratch.capacity[slot] * sizeof(double) > retentionBytes.load(std::memory_order_relaxed)) {
+        scratch.drop(slot);
+    }
+}
+
+void setScratchRetention(std::uint64_t bytes) {
+    retentionBytes.store(bytes, std::memory_order_relaxed);
+}
+
+std::uint64_t scratchRetention() {
+    return retentionBytes.load(std::memory_order_relaxed);
+}
+
+void trimScratch() {
+    ThreadScratch& scratch = threadScratch();
+    for (int slot = 0; slot < SCRATCH_SLOTS; ++slot) {
+        scratch.drop(slot);
+    }
+}
+
+} // namespace memory
+} // namespace matrix
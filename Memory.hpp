@@ -0,0 +1,82 @@
+//agassinoa20@gmail.com
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace matrix {
+namespace memory {
+
+/// @brief Allocation sizes are grouped by powers of two: class c holds
+/// 2^(c-1) < bytes <= 2^c, the last class takes everything larger.
+const int SIZE_CLASSES = 40;
+int sizeClass(std::size_t bytes);
+
+/// @brief Point-in-time copy of the accounting counters.
+struct Usage {
+    std::uint64_t liveBytes = 0;
+    std::uint64_t peakBytes = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t releases = 0;
+    std::uint64_t rejected = 0;  // refused by the budget or by the allocator
+    std::uint64_t sizeHistogram[SIZE_CLASSES] = {};
+};
+
+/// @brief Allocates `elements` doubles (uninitialized) and accounts for them.
+/// Throws MatrixException when the allocation would push live bytes over the
+/// budget, or when the system allocator fails.
+double* allocate(std::size_t elements);
+
+/// @brief Frees a buffer from allocate(); `elements` must match. Null is ignored.
+void release(double* data, std::size_t elements);
+
+/// @brief Hard cap on live bytes; 0 (the default) means unlimited. Buffers that
+/// are already live stay valid when the budget is lowered below them.
+void setBudget(std::uint64_t bytes);
+std::uint64_t budget();
+
+Usage usage();
+
+/// @brief Restarts the high-water mark from the current live bytes.
+void resetPeak();
+
+/// @brief Independent scratch slots per thread. SquareMat.cpp uses 0-3 (output
+/// parameters and aliased matrix-vector products, powers, in-place multiply), the gemm kernels use 4 and the
+/// low-rank kernels use 5.
+const int SCRATCH_SLOTS = 6;
+
+/// @brief Per-thread scratch buffer leased for the duration of one kernel.
+/// Storage comes from allocate(), so it counts against the budget and shows in
+/// usage(). The thread keeps a slot's buffer between leases, so a loop stops
+/// allocating once it has seen its largest size, but only while the buffer is
+/// at most scratchRetention() bytes: a larger one is released when its lease
+/// ends. A slot may be leased only once at a time on a thread.
+class Scratch {
+private:
+    int slot;
+    double* buffer;
+
+public:
+    Scratch(int slot, std::size_t elements);
+    ~Scratch();
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    double* data() const {
+        return buffer;
+    }
+};
+
+/// @brief Largest buffer (in bytes) a thread keeps per slot between leases;
+/// 4 MiB by default, 0 keeps nothing.
+void setScratchRetention(std::uint64_t bytes);
+std::uint64_t scratchRetention();
+
+/// @brief Releases the calling thread's idle scratch buffers.
+void trimScratch();
+
+} // namespace memory
+} // namespace matrix
+
+#endif // MEMORY_HPP
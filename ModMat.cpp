@@ -0,0 +1,349 @@
+//agassinoa20@gmail.com
+#include "ModMat.hpp"
+#include "Parallel.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace matrix {
+
+__extension__ typedef unsigned __int128 uint128;
+
+// Minimum multiply-adds a parallel chunk of rows should carry.
+static const long PARALLEL_WORK = 1L << 20;
+
+static std::uint64_t cellCount(int n) {
+    return static_cast<std::uint64_t>(n) * static_cast<std::uint64_t>(n);
+}
+
+/// @brief Barrett constant floor(2^128 / m) for 1 < m < 2^63
+static uint128 barrettFactor(std::uint64_t m) {
+    uint128 all = ~uint128(0);
+    uint128 mu = all / m;
+    return all % m == m - 1 ? mu + 1 : mu;
+}
+
+/// @brief x mod m for any 128-bit x. q = high128(x * mu) is floor(x / m) or one
+/// less, so one conditional subtract finishes the job; r < 2m fits 64 bits.
+static std::uint64_t barrettReduce(uint128 x, uint128 mu, std::uint64_t m) {
+    std::uint64_t x0 = static_cast<std::uint64_t>(x);
+    std::uint64_t x1 = static_cast<std::uint64_t>(x >> 64);
+    std::uint64_t m0 = static_cast<std::uint64_t>(mu);
+    std::uint64_t m1 = static_cast<std::uint64_t>(mu >> 64);
+    uint128 p00 = static_cast<uint128>(x0) * m0;
+    uint128 p01 = static_cast<uint128>(x0) * m1;
+    uint128 p10 = static_cast<uint128>(x1) * m0;
+    uint128 p11 = static_cast<uint128>(x1) * m1;
+    uint128 mid = (p00 >> 64) + static_cast<std::uint64_t>(p01) + static_cast<std::uint64_t>(p10);
+    uint128 q = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+    std::uint64_t r = x0 - static_cast<std::uint64_t>(q) * m;
+    return r >= m ? r - m : r;
+}
+
+/// @brief x mod m for 64-bit x and m <= 2^32 with mu = floor((2^64 - 1) / m):
+/// the quotient estimate is off by at most one
+static std::uint64_t barrettReduce(std::uint64_t x, std::uint64_t mu, std::uint64_t m) {
+    std::uint64_t q = static_cast<std::uint64_t>((static_cast<uint128>(x) * mu) >> 64);
+    std::uint64_t r = x - q * m;
+    return r >= m ? r - m : r;
+}
+
+/// @brief acc += scale * row for factors below 2^32: a 32x32->64 multiply per
+/// lane (pmuludq on SSE2), which the vectorizer uses once __restrict rules
+/// out overlap
+static void addScaledRow(int n, std::uint32_t scale, const std::uint64_t* __restrict row,
+                         std::uint64_t* __restrict acc) {
+    for (int j = 0; j < n; ++j) {
+        acc[j] += static_cast<std::uint64_t>(scale) * static_cast<std::uint32_t>(row[j]);
+    }
+}
+
+/// @brief C = A * B mod m over rows [i0, i1); C must not overlap A or B.
+/// Terms are summed unreduced for `batch` values of k (as many as cannot
+/// overflow the accumulator), then the accumulator row is reduced once.
+static void multiplyRows(int n, std::uint64_t m, const std::uint64_t* a, const std::uint64_t* b,
+                         std::uint64_t* c, int i0, int i1) {
+    std::uint64_t top = m - 1;
+    if (m <= (std::uint64_t(1) << 32)) {
+        std::uint64_t limit = std::numeric_limits<std::uint64_t>::max() - top;
+        std::uint64_t batch = top == 0 ? n : limit / (top * top);
+        std::uint64_t mu = std::numeric_limits<std::uint64_t>::max() / m;
+        std::vector<std::uint64_t> acc(n);
+        for (int i = i0; i < i1; ++i) {
+            std::fill(acc.begin(), acc.end(), 0);
+            std::uint64_t pending = 0;
+            for (int k = 0; k < n; ++k) {
+                std::uint64_t aik = a[i * n + k];
+                if (aik == 0) {
+                    continue;
+                }
+                addScaledRow(n, static_cast<std::uint32_t>(aik), b + k * n, acc.data());
+                if (++pending == batch) {
+                    for (int j = 0; j < n; ++j) {
+                        acc[j] = barrettReduce(acc[j], mu, m);
+                    }
+                    pending = 0;
+                }
+            }
+            for (int j = 0; j < n; ++j) {
+                c[i * n + j] = barrettReduce(acc[j], mu, m);
+            }
+        }
+        return;
+    }
+    uint128 mu = barrettFactor(m);
+    uint128 square = static_cast<uint128>(top) * top;
+    uint128 batch = (~uint128(0) - top) / square;
+    std::vector<uint128> acc(n);
+    for (int i = i0; i < i1; ++i) {
+        std::fill(acc.begin(), acc.end(), 0);
+        uint128 pending = 0;
+        for (int k = 0; k < n; ++k) {
+            std::uint64_t aik = a[i * n + k];
+            if (aik == 0) {
+                continue;
+            }
+            const std::uint64_t* bRow = b + k * n;
+            for (int j = 0; j < n; ++j) {
+                acc[j] += static_cast<uint128>(aik) * bRow[j];
+            }
+            if (++pending == batch) {
+                for (int j = 0; j < n; ++j) {
+                    acc[j] = barrettReduce(acc[j], mu, m);
+                }
+                pending = 0;
+            }
+        }
+        for (int j = 0; j < n; ++j) {
+            c[i * n + j] = barrettReduce(acc[j], mu, m);
+        }
+    }
+}
+
+/// @brief C = A * B mod m, rows split across the shared pool
+static void multiplyMod(int n, std::uint64_t m, const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* c) {
+    if (m == 1) {
+        std::fill(c, c + cellCount(n), 0);
+        return;
+    }
+    long perRow = static_cast<long>(n) * n;
+    long grain = PARALLEL_WORK / (perRow > 0 ? perRow : 1) + 1;
+    detail::parallelFor(0, n, static_cast<int>(std::min(grain, static_cast<long>(n))), [=](int i0, int i1) {
+        multiplyRows(n, m, a, b, c, i0, i1);
+    });
+}
+
+static std::uint64_t reduceSigned(std::int64_t value, std::uint64_t m) {
+    if (value >= 0) {
+        return static_cast<std::uint64_t>(value) % m;
+    }
+    // -(value + 1) cannot overflow, unlike -value for INT64_MIN
+    std::uint64_t magnitude = (static_cast<std::uint64_t>(-(value + 1)) + 1) % m;
+    return magnitude == 0 ? 0 : m - magnitude;
+}
+
+ModMat::ModMat(int n, std::uint64_t modulus) : size(n), modulus(modulus) {
+    if (n <= 0) {
+        throw MatrixException("matrix size must be positive");
+    }
+    if (modulus == 0 || modulus >= MAX_MODULUS) {
+        throw MatrixException("modulus must be in [1, 2^63)");
+    }
+    cells.assign(cellCount(n), 0);
+}
+
+ModMat::ModMat(int n, std::uint64_t modulus, const std::int64_t* data) : ModMat(n, modulus) {
+    for (std::uint64_t i = 0; i < cellCount(n); ++i) {
+        cells[i] = reduceSigned(data[i], modulus);
+    }
+}
+
+ModMat::ModMat(const SquareMat& mat, std::uint64_t modulus) : ModMat(mat.getSize(), modulus) {
+    const double* src = mat.data();
+    for (std::uint64_t i = 0; i < cellCount(size); ++i) {
+        double value = src[i];
+        if (value != std::trunc(value) || std::fabs(value) >= 9223372036854775808.0) {
+            throw MatrixException("ModMat elements must be integers below 2^63 in magnitude");
+        }
+        cells[i] = reduceSigned(static_cast<std::int64_t>(value), modulus);
+    }
+}
+
+ModMat ModMat::identity(int n, std::uint64_t modulus) {
+    ModMat result(n, modulus);
+    for (int i = 0; i < n; ++i) {
+        result.cells[i * n + i] = 1 % modulus;
+    }
+    return result;
+}
+
+void ModMat::checkCompatible(const ModMat& other, const char* message) const {
+    if (size != other.size) {
+        throw MatrixException(message);
+    }
+    if (modulus != other.modulus) {
+        throw MatrixException("ModMat operands must share the same modulus");
+    }
+}
+
+std::uint64_t ModMat::at(int i, int j) const {
+    if (i < 0 || i >= size || j < 0 || j >= size) {
+        throw MatrixException("Index out of bounds");
+    }
+    return cells[i * size + j];
+}
+
+void ModMat::set(int i, int j, std::int64_t value) {
+    if (i < 0 || i >= size || j < 0 || j >= size) {
+        throw MatrixException("Index out of bounds");
+    }
+    cells[i * size + j] = reduceSigned(value, modulus);
+}
+
+std::uint64_t* ModMat::data() {
+    return cells.data();
+}
+
+const std::uint64_t* ModMat::data() const {
+    return cells.data();
+}
+
+int ModMat::getSize() const {
+    return size;
+}
+
+std::uint64_t ModMat::getModulus() const {
+    return modulus;
+}
+
+/// @brief Both operands are below m < 2^63, so the sum cannot wrap
+ModMat& ModMat::operator+=(const ModMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Add, size, cellCount(size), cellCount(size) * sizeof(std::uint64_t) * 3);
+    checkCompatible(rhs, "Matrices must have the same dimensions for +=");
+    for (std::uint64_t i = 0; i < cells.size(); ++i) {
+        std::uint64_t sum = cells[i] + rhs.cells[i];
+        cells[i] = sum >= modulus ? sum - modulus : sum;
+    }
+    return *this;
+}
+
+ModMat& ModMat::operator-=(const ModMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Subtract, size, cellCount(size), cellCount(size) * sizeof(std::uint64_t) * 3);
+    checkCompatible(rhs, "Matrices must have the same dimensions for -=");
+    for (std::uint64_t i = 0; i < cells.size(); ++i) {
+        std::uint64_t value = cells[i];
+        cells[i] = value >= rhs.cells[i] ? value - rhs.cells[i] : value + (modulus - rhs.cells[i]);
+    }
+    return *this;
+}
+
+ModMat& ModMat::operator*=(const ModMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Multiply, size, 2 * cellCount(size) * size, cellCount(size) * sizeof(std::uint64_t) * 3);
+    checkCompatible(rhs, "Matrices must have the same dimensions for multiplication");
+    std::vector<std::uint64_t> product(cells.size());
+    multiplyMod(size, modulus, cells.data(), rhs.cells.data(), product.data());
+    cells.swap(product);
+    SQUAREMAT_OP_ALGORITHM(modulus <= (std::uint64_t(1) << 32) ? "modular-lazy-64" : "modular-barrett-128");
+    return *this;
+}
+
+ModMat& ModMat::operator*=(std::uint64_t scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, size, cellCount(size), cellCount(size) * sizeof(std::uint64_t) * 2);
+    std::uint64_t s = scalar % modulus;
+    for (std::uint64_t& value : cells) {
+        value = static_cast<std::uint64_t>(static_cast<uint128>(value) * s % modulus);
+    }
+    return *this;
+}
+
+/// @brief Square-and-multiply over the bits of a 64-bit exponent, ping-ponging
+/// between two product buffers instead of allocating per step
+ModMat ModMat::operator^(std::uint64_t power) const {
+    [[maybe_unused]] int bits = 0;
+    for (std::uint64_t p = power; p > 0; p >>= 1) {
+        bits += 1 + static_cast<int>(p & 1);
+    }
+    SQUAREMAT_OP_SCOPE(Power, size, static_cast<std::uint64_t>(bits) * 2 * cellCount(size) * size,
+                       static_cast<std::uint64_t>(bits) * cellCount(size) * sizeof(std::uint64_t) * 3);
+    ModMat result = identity(size, modulus);
+    std::vector<std::uint64_t> base = cells;
+    std::vector<std::uint64_t> spare(cells.size());
+    bool first = true;
+    while (power > 0) {
+        if (power & 1) {
+            if (first) {
+                result.cells = base;
+                first = false;
+            } else {
+                multiplyMod(size, modulus, result.cells.data(), base.data(), spare.data());
+                result.cells.swap(spare);
+            }
+        }
+        power >>= 1;
+        if (power > 0) {
+            multiplyMod(size, modulus, base.data(), base.data(), spare.data());
+            base.swap(spare);
+        }
+    }
+    SQUAREMAT_OP_ALGORITHM("modular-binary-exponentiation");
+    return result;
+}
+
+bool ModMat::operator==(const ModMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, cellCount(size), cellCount(size) * sizeof(std::uint64_t) * 2);
+    return size == other.size && modulus == other.modulus && cells == other.cells;
+}
+
+bool ModMat::operator!=(const ModMat& other) const {
+    return !(*this == other);
+}
+
+SquareMat ModMat::toSquareMat() const {
+    SquareMat result(size);
+    double* out = result.data();
+    for (std::uint64_t i = 0; i < cells.size(); ++i) {
+        out[i] = static_cast<double>(cells[i]);
+    }
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const ModMat& mat) {
+    for (int i = 0; i < mat.size; ++i) {
+        for (int j = 0; j < mat.size; ++j) {
+            os << mat.cells[i * mat.size + j] << " ";
+        }
+        os << "\n";
+    }
+    return os;
+}
+
+ModMat operator+(const ModMat& lhs, const ModMat& rhs) {
+    ModMat result(lhs);
+    result += rhs;
+    return result;
+}
+
+ModMat operator-(const ModMat& lhs, const ModMat& rhs) {
+    ModMat result(lhs);
+    result -= rhs;
+    return result;
+}
+
+ModMat operator*(const ModMat& lhs, const ModMat& rhs) {
+    ModMat result(lhs);
+    result *= rhs;
+    return result;
+}
+
+ModMat operator*(const ModMat& mat, std::uint64_t scalar) {
+    ModMat result(mat);
+    result *= scalar;
+    return result;
+}
+
+ModMat operator*(std::uint64_t scalar, const ModMat& mat) {
+    return mat * scalar;
+}
+
+} // namespace matrix
@@ -0,0 +1,70 @@
+//agassinoa20@gmail.com
+#ifndef MODMAT_HPP
+#define MODMAT_HPP
+
+#include "SquareMat.hpp"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace matrix {
+
+/// @brief Square matrix over the integers mod m (1 <= m < 2^63), for exact
+/// counting and linear recurrences where doubles lose precision. Elements are
+/// uint64 kept fully reduced in [0, m). Products accumulate without reducing
+/// each term: moduli below 2^32 sum 64-bit products and reduce once per batch
+/// of rows of B (a vectorizable j-loop), larger moduli sum 128-bit products and
+/// Barrett-reduce when the sum nears overflow. Rows are split across the shared
+/// pool. Mixing moduli throws MatrixException.
+class ModMat {
+private:
+    int size;
+    std::uint64_t modulus;
+    std::vector<std::uint64_t> cells;  // row-major
+
+    void checkCompatible(const ModMat& other, const char* message) const;
+
+public:
+    static const std::uint64_t MAX_MODULUS = std::uint64_t(1) << 63;  // exclusive
+
+    ModMat(int n, std::uint64_t modulus);  // zero matrix
+    ModMat(int n, std::uint64_t modulus, const std::int64_t* data);  // reduces, negatives included
+    ModMat(const SquareMat& mat, std::uint64_t modulus);  // elements must be integers
+
+    static ModMat identity(int n, std::uint64_t modulus);
+
+    std::uint64_t at(int i, int j) const;
+    void set(int i, int j, std::int64_t value);  // reduced mod m
+
+    // Row-major, row i is data()[i * size, (i + 1) * size); values must stay below m.
+    std::uint64_t* data();
+    const std::uint64_t* data() const;
+
+    int getSize() const;
+    std::uint64_t getModulus() const;
+
+    ModMat& operator+=(const ModMat& rhs);
+    ModMat& operator-=(const ModMat& rhs);
+    ModMat& operator*=(const ModMat& rhs);
+    ModMat& operator*=(std::uint64_t scalar);
+
+    /// @brief Binary exponentiation, 64-bit exponents (e.g. 10^18) included.
+    ModMat operator^(std::uint64_t power) const;
+
+    bool operator==(const ModMat& other) const;  // element-wise, same modulus
+    bool operator!=(const ModMat& other) const;
+
+    SquareMat toSquareMat() const;  // exact while elements are below 2^53
+
+    friend std::ostream& operator<<(std::ostream& os, const ModMat& mat);
+};
+
+ModMat operator+(const ModMat& lhs, const ModMat& rhs);
+ModMat operator-(const ModMat& lhs, const ModMat& rhs);
+ModMat operator*(const ModMat& lhs, const ModMat& rhs);
+ModMat operator*(const ModMat& mat, std::uint64_t scalar);
+ModMat operator*(std::uint64_t scalar, const ModMat& mat);
+
+} // namespace matrix
+
+#endif // MODMAT_HPP
@@ -0,0 +1,44 @@
+//agassinoa20@gmail.com
+#include "Parallel.hpp"
+#include "ThreadPool.hpp"
+
+namespace matrix {
+namespace detail {
+
+int workerCount() {
+    return ThreadPool::shared().size();
+}
+
+void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    int length = end - begin;
+    if (length <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+    int chunks = length / grain;
+    if (chunks > workerCount()) {
+        chunks = workerCount();
+    }
+    if (chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+    // spread the remainder so chunk lengths differ by at most one
+    TaskGroup group(ThreadPool::shared());
+    int chunkBegin = begin;
+    for (int c = 0; c < chunks; ++c) {
+        int chunkEnd = chunkBegin + length / chunks + (c < length % chunks ? 1 : 0);
+        if (c == chunks - 1) {
+            body(chunkBegin, chunkEnd);
+        } else {
+            group.run([&body, chunkBegin, chunkEnd] { body(chunkBegin, chunkEnd); });
+        }
+        chunkBegin = chunkEnd;
+    }
+    group.wait();
+}
+
+} // namespace detail
+} // namespace matrix
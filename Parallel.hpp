@@ -0,0 +1,23 @@
+//agassinoa20@gmail.com
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <functional>
+
+namespace matrix {
+namespace detail {
+
+/// @brief Threads the parallel kernels use: the size of ThreadPool::shared().
+int workerCount();
+
+/// @brief Runs body(chunkBegin, chunkEnd) over disjoint chunks covering
+/// [begin, end), each at least `grain` long, as up to workerCount() fork/join
+/// tasks on the shared pool (the caller runs one chunk itself and helps with
+/// the rest). Returns once every chunk is done; safe to nest.
+/// body must not throw.
+void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+} // namespace detail
+} // namespace matrix
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,157 @@
+//agassinoa20@gmail.com
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace matrix {
+namespace perf {
+
+static const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses",
+};
+
+const char* counterName(Counter counter) {
+    int index = static_cast<int>(counter);
+    if (index < 0 || index >= COUNTER_COUNT) {
+        return "?";
+    }
+    return COUNTER_NAMES[index];
+}
+
+bool Reading::has(Counter counter) const {
+    return valid[static_cast<int>(counter)];
+}
+
+std::uint64_t Reading::get(Counter counter) const {
+    return values[static_cast<int>(counter)];
+}
+
+#ifdef __linux__
+
+static std::uint64_t cacheMissConfig(std::uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+/// @brief Opens one disabled, user-space-only counter on the calling thread and
+/// the threads it creates afterwards; -1 if unsupported
+static int openCounter(Counter counter) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;  // include pool workers started after the counters
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (counter) {
+    case Counter::Cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case Counter::Instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case Counter::L1DMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cacheMissConfig(PERF_COUNT_HW_CACHE_L1D);
+        break;
+    case Counter::LLCMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case Counter::DTLBMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cacheMissConfig(PERF_COUNT_HW_CACHE_DTLB);
+        break;
+    default:
+        return -1;
+    }
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return static_cast<int>(fd);
+}
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        fds[i] = openCounter(static_cast<Counter>(i));
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+void PerfCounters::start() {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+Reading PerfCounters::stop() {
+    Reading reading;
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        std::uint64_t raw[3];  // value, time enabled, time running
+        if (read(fds[i], raw, sizeof(raw)) != static_cast<ssize_t>(sizeof(raw)) || raw[2] == 0) {
+            continue;
+        }
+        double scale = static_cast<double>(raw[1]) / static_cast<double>(raw[2]);
+        reading.values[i] = static_cast<std::uint64_t>(static_cast<double>(raw[0]) * scale);
+        reading.valid[i] = true;
+    }
+    return reading;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        fds[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::start() {}
+
+Reading PerfCounters::stop() {
+    return Reading();
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (fds[i] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PerfCounters::available(Counter counter) const {
+    return fds[static_cast<int>(counter)] >= 0;
+}
+
+} // namespace perf
+} // namespace matrix
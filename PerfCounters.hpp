@@ -0,0 +1,60 @@
+//agassinoa20@gmail.com
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstdint>
+
+namespace matrix {
+namespace perf {
+
+/// @brief Hardware events the benchmark can read around a kernel.
+enum class Counter {
+    Cycles,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    DTLBMisses,
+    Count  // number of counters, not a counter
+};
+
+const int COUNTER_COUNT = static_cast<int>(Counter::Count);
+const char* counterName(Counter counter);
+
+/// @brief Counter deltas between start() and stop(). Values are scaled up when
+/// the kernel multiplexed a counter, and `valid` is false for counters that
+/// could not be opened on this machine.
+struct Reading {
+    std::uint64_t values[COUNTER_COUNT] = {};
+    bool valid[COUNTER_COUNT] = {};
+
+    bool has(Counter counter) const;
+    std::uint64_t get(Counter counter) const;
+};
+
+/// @brief User-space counters through Linux perf_event_open. They count the
+/// constructing thread and every thread it starts later (children inherit the
+/// counters), so construct them before the thread pool spins up or work run on
+/// already-running workers is missed. Every counter is opened on its own, so one unsupported event (common in VMs
+/// and containers, or with kernel.perf_event_paranoid > 2) only disables that
+/// column; on other platforms nothing is available and readings are empty.
+class PerfCounters {
+private:
+    int fds[COUNTER_COUNT];
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;  // at least one counter opened
+    bool available(Counter counter) const;
+
+    void start();
+    Reading stop();
+};
+
+} // namespace perf
+} // namespace matrix
+
+#endif // PERF_COUNTERS_HPP
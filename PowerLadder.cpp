@@ -0,0 +1,139 @@
+//agassinoa20@gmail.com
+#include "PowerLadder.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+
+namespace matrix {
+
+/// @brief Index of the highest set bit (k > 0)
+static int topBit(int k) {
+    int bit = 0;
+    while (k >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+/// @brief Squares kept: the base (shared with the caller, so free) plus as many
+/// n x n squares as fit in maxCacheBytes, and never more than an int exponent uses
+static int squaresFor(int n, std::uint64_t maxCacheBytes) {
+    std::uint64_t squareBytes = static_cast<std::uint64_t>(n) * static_cast<std::uint64_t>(n) * sizeof(double);
+    std::uint64_t extra = maxCacheBytes / squareBytes;
+    return extra >= 30 ? 31 : 1 + static_cast<int>(extra);
+}
+
+static_assert(30 * 373 * 373 * sizeof(double) <= PowerLadder::DEFAULT_MAX_CACHE_BYTES &&
+                  30 * 374 * 374 * sizeof(double) > PowerLadder::DEFAULT_MAX_CACHE_BYTES,
+              "the PowerLadder doc states the full ladder fits up to n = 373");
+
+PowerLadder::PowerLadder(const SquareMat& base, std::uint64_t maxCacheBytes)
+    : base(base), maxSquares(squaresFor(base.getSize(), maxCacheBytes)), overflow(base),
+      current(SquareMat::identity(base.getSize())), currentPower(0) {
+    squares.push_back(base);  // O(1) copy-on-write copy
+}
+
+/// @brief base^(2^bit): cached when bit < maxSquares, otherwise squared on from
+/// the last cached one in `overflow` (overflowBit starts at -1; bits must be requested in ascending order)
+const SquareMat& PowerLadder::square(int bit, int& overflowBit) {
+    while (static_cast<int>(squares.size()) <= bit && static_cast<int>(squares.size()) < maxSquares) {
+        SquareMat next(base.getSize());
+        multiply(next, squares.back(), squares.back());
+        squares.push_back(next);
+    }
+    if (bit < static_cast<int>(squares.size())) {
+        return squares[bit];
+    }
+    if (overflowBit < 0) {
+        overflow = squares.back();
+        overflowBit = static_cast<int>(squares.size()) - 1;
+    }
+    while (overflowBit < bit) {
+        multiply(overflow, overflow, overflow);
+        ++overflowBit;
+    }
+    return overflow;
+}
+
+SquareMat PowerLadder::power(int k) {
+    SquareMat result(base.getSize());
+    power(result, k);
+    return result;
+}
+
+void PowerLadder::power(SquareMat& dst, int k) {
+    int n = base.getSize();
+    if (k < 0) {
+        throw MatrixException("Negative powers not supported");
+    }
+    if (dst.getSize() != n) {
+        throw MatrixException("Destination must have the operands' size");
+    }
+    std::uint64_t setBits = 0;
+    for (int p = k; p > 0; p /= 2) {
+        setBits += p % 2;
+    }
+    int highest = k > 0 ? topBit(k) : 0;
+    int cached = static_cast<int>(squares.size());
+    std::uint64_t newSquares = highest >= cached ? static_cast<std::uint64_t>(highest - cached + 1) : 0;
+    [[maybe_unused]] std::uint64_t multiplies = newSquares + (setBits > 0 ? setBits - 1 : 0);
+    [[maybe_unused]] std::uint64_t cellCount = static_cast<std::uint64_t>(n) * static_cast<std::uint64_t>(n);
+    SQUAREMAT_OP_SCOPE(Power, n, multiplies * 2 * cellCount * n, multiplies * cellCount * sizeof(double) * 3);
+
+    int overflowBit = -1;
+    bool identity = true;
+    for (int bit = 0; bit <= highest && k > 0; ++bit) {
+        if (((k >> bit) & 1) == 0) {
+            continue;
+        }
+        const SquareMat& factor = square(bit, overflowBit);
+        if (identity) {
+            const double* src = factor.data();
+            std::copy(src, src + static_cast<std::size_t>(n) * n, dst.data());
+            identity = false;
+        } else {
+            multiply(dst, dst, factor);
+        }
+    }
+    if (identity) {
+        double* out = dst.data();
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                out[i * n + j] = (i == j) ? 1.0 : 0.0;
+            }
+        }
+    }
+    SQUAREMAT_OP_ALGORITHM("power-ladder");
+}
+
+const SquareMat& PowerLadder::next() {
+    if (currentPower == 0) {
+        current = base;  // shared until the next step writes it
+    } else {
+        multiply(current, current, base);
+    }
+    ++currentPower;
+    return current;
+}
+
+void PowerLadder::seek(int k) {
+    current = power(k);
+    currentPower = k;
+}
+
+int PowerLadder::position() const {
+    return currentPower;
+}
+
+const SquareMat& PowerLadder::getBase() const {
+    return base;
+}
+
+int PowerLadder::cachedSquares() const {
+    return static_cast<int>(squares.size());
+}
+
+void PowerLadder::clear() {
+    squares.erase(squares.begin() + 1, squares.end());
+}
+
+} // namespace matrix
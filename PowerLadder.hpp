@@ -0,0 +1,59 @@
+//agassinoa20@gmail.com
+#ifndef POWER_LADDER_HPP
+#define POWER_LADDER_HPP
+
+#include "SquareMat.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace matrix {
+
+/// @brief Memoized repeated squares of one base, for sweeps over many
+/// exponents: power(k) reuses base^(2^i) from earlier calls and only pays the
+/// combine multiplies (one per set bit of k beyond the first). The cache is
+/// bounded in bytes: squares beyond the base are kept while they fit in
+/// `maxCacheBytes` (n * n doubles each, allocated through the memory layer and
+/// so also subject to its budget), and higher ones are recomputed per call.
+/// The default of 32 MiB keeps all 31 squares an int exponent can need (the
+/// base plus 30 cached, 30 * n * n * 8 bytes) up to n = 373 and fewer above; a
+/// larger cache trades memory for fewer squarings.
+/// next() walks consecutive powers with one multiply each.
+class PowerLadder {
+private:
+    SquareMat base;
+    std::vector<SquareMat> squares;  // squares[i] = base^(2^i)
+    int maxSquares;      // derived from the byte bound, base included
+    SquareMat overflow;  // squares past maxSquares, rebuilt per power() call
+    SquareMat current;
+    int currentPower;
+
+    const SquareMat& square(int bit, int& overflowBit);
+
+public:
+    // 30 * 373 * 373 * 8 <= 32 MiB < 30 * 374 * 374 * 8
+    static const std::uint64_t DEFAULT_MAX_CACHE_BYTES = std::uint64_t(32) << 20;
+
+    explicit PowerLadder(const SquareMat& base, std::uint64_t maxCacheBytes = DEFAULT_MAX_CACHE_BYTES);
+
+    /// @brief base^k (MatrixException for k < 0).
+    SquareMat power(int k);
+
+    /// @brief base^k into dst, which must have the base's size.
+    void power(SquareMat& dst, int k);
+
+    /// @brief Advances the walk by one and returns base^position(); the walk
+    /// starts at base^0, so the first call returns the base itself.
+    const SquareMat& next();
+
+    /// @brief Restarts the walk at base^k.
+    void seek(int k);
+    int position() const;
+
+    const SquareMat& getBase() const;
+    int cachedSquares() const;
+    void clear();  // drops the cached squares
+};
+
+} // namespace matrix
+
+#endif // POWER_LADDER_HPP
@@ -1,16 +1,103 @@
 //agassinoa20@gmail.com
 #include "SquareMat.hpp"
+#include "Kernels.hpp"
+#include "MatrixView.hpp"
+#include "Memory.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <new>
+#include <utility>
 
 namespace matrix {
 
+// Nominal work per call, reported through SQUAREMAT_OP_SCOPE when SQUAREMAT_STATS is on.
+static std::uint64_t cells(int n) {
+    return static_cast<std::uint64_t>(n) * static_cast<std::uint64_t>(n);
+}
+
+[[maybe_unused]] static std::uint64_t cellBytes(int n, int passes) {
+    return cells(n) * sizeof(double) * static_cast<std::uint64_t>(passes);
+}
+
+[[maybe_unused]] static std::uint64_t powerMultiplies(int power) {
+    // one squaring per bit plus one combine per set bit
+    std::uint64_t multiplies = 0;
+    for (int p = power; p > 0; p /= 2) {
+        multiplies += 1 + (p % 2);
+    }
+    return multiplies;
+}
+
+// Rows per panel of the in-place multiply: the panel result is the only
+// scratch, and tall enough that gemm still streams B in long runs.
+static const int INPLACE_PANEL = 128;
+
+// Matrix buffers are reference counted for copy-on-write: one extra leading
+// slot holds the count, and `matrix` points just past it. Copies share the
+// buffer; prepareWrite() gives a writer its own copy while it is shared.
+using RefCount = std::atomic<std::int64_t>;
+static_assert(sizeof(RefCount) <= sizeof(double) && alignof(RefCount) <= alignof(double),
+              "reference count must fit the slot in front of the elements");
+
+static RefCount& refCount(double* buffer) {
+    return *reinterpret_cast<RefCount*>(buffer - 1);
+}
+
+/// @brief Allocates an uninitialized n x n buffer with a count of 1; every
+/// SquareMat buffer comes from here so the memory layer can account for it
+/// (and enforce its budget)
+static double* newBuffer(int n) {
+    double* block = memory::allocate(cells(n) + 1);
+    SQUAREMAT_COUNT_ALLOCATION(cellBytes(n, 1) + sizeof(double));
+    new (block) RefCount(1);
+    return block + 1;
+}
+
+/// @brief Drops one reference; the last owner frees the buffer
+static void freeBuffer(double* buffer, int n) {
+    if (refCount(buffer).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        refCount(buffer).~RefCount();
+        memory::release(buffer - 1, cells(n) + 1);
+    }
+}
+
+static double* shareBuffer(double* buffer) {
+    refCount(buffer).fetch_add(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+/// @brief Slow path of prepareWrite(): drops the cached hash and detaches a
+/// shared buffer, after which writes skip both until the next share
+void SquareMat::makeWritable() {
+    hashCache.store(HASH_UNSET, std::memory_order_relaxed);
+    if (isShared()) {
+        detach();
+    }
+    writable.store(true, std::memory_order_relaxed);
+}
+
+/// @brief Replaces a shared buffer with a private copy of it
+void SquareMat::detach() {
+    SQUAREMAT_OP_SCOPE(Copy, size, 0, cellBytes(size, 2));
+    double* copy = newBuffer(size);
+    std::copy(matrix, matrix + cells(size), copy);
+    freeBuffer(matrix, size);
+    matrix = copy;
+}
+
 /// @brief Constructor that initializes a size x size matrix with zeros
 SquareMat::SquareMat(int size) : size(size), matrix(nullptr) {
     if (size <= 0) {
         throw MatrixException("matrix size must be positive");
     }
-    matrix = new double[size * size];
+    SQUAREMAT_OP_SCOPE(Construct, size, 0, cellBytes(size, 1));
+    matrix = newBuffer(size);
     for (int i = 0; i < size * size; ++i) {
         matrix[i] = 0.0;
     }
@@ -21,78 +108,91 @@ SquareMat::SquareMat(int size, const double* initData) : size(size), matrix(null
     if (size <= 0) {
         throw MatrixException("matrix size must be positive");
     }
-    matrix = new double[size * size];
+    SQUAREMAT_OP_SCOPE(Construct, size, 0, cellBytes(size, 2));
+    matrix = newBuffer(size);
     for (int i = 0; i < size * size; ++i) {
         matrix[i] = initData[i];
     }
 }
 
-/// @brief Copy constructor that performs deep copy
-SquareMat::SquareMat(const SquareMat& other) : size(other.size), matrix(new double[other.size * other.size]) {
-    copyMem(other);
+/// @brief Copy constructor: O(1), shares the buffer until one side writes
+SquareMat::SquareMat(const SquareMat& other)
+    : size(other.size), matrix(shareBuffer(other.matrix)),
+      hashCache(other.hashCache.load(std::memory_order_relaxed)) {
+    SQUAREMAT_OP_SCOPE(Copy, size, 0, 0);
+    other.writable.store(false, std::memory_order_relaxed);
 }
 
-/// @brief Assignment operator that handles self-assignment and deep copy
+/// @brief Materializes a lazy transpose into an owning matrix
+SquareMat::SquareMat(const TransposedMat& view) : size(view.getSize()), matrix(nullptr) {
+    SQUAREMAT_OP_SCOPE(Transpose, size, 0, cellBytes(size, 2));
+    matrix = newBuffer(size);
+    detail::transpose(size, view.base().matrix, size, matrix, size);
+}
+
+/// @brief Copies the contents of a (possibly strided or transposed) view
+SquareMat::SquareMat(const ConstMatrixView& view) : size(view.getSize()), matrix(nullptr) {
+    SQUAREMAT_OP_SCOPE(Copy, size, 0, cellBytes(size, 2));
+    matrix = newBuffer(size);
+    MatrixView(matrix, size, size).assign(view);
+}
+
+/// @brief Assignment shares other's buffer (copy-on-write), releasing ours
 SquareMat& SquareMat::operator=(const SquareMat& other) {
-    if (this != &other) {
-        if (this->size != other.size) {
-            delete[] matrix;
-            size = other.size;
-            matrix = new double[size * size];
-        }
-        copyMem(other);
+    SQUAREMAT_OP_SCOPE(Copy, other.size, 0, 0);
+    if (matrix != other.matrix) {
+        double* buffer = shareBuffer(other.matrix);
+        freeBuffer(matrix, size);
+        size = other.size;
+        matrix = buffer;
+        hashCache.store(other.hashCache.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        writable.store(false, std::memory_order_relaxed);
+        other.writable.store(false, std::memory_order_relaxed);
     }
     return *this;
 }
 
-/// @brief Destructor to free matrix memory
+/// @brief Destructor: releases this owner's reference
 SquareMat::~SquareMat() {
-    delete[] matrix;
+    freeBuffer(matrix, size);
 }
 
-/// @brief Helper to copy matrix contents
-void SquareMat::copyMem(const SquareMat& other) {
-    for (int i = 0; i < size * size; ++i) {
-        matrix[i] = other.matrix[i];
-    }
+/// @brief Mutable view of the whole matrix
+MatrixView SquareMat::view() {
+    prepareWrite();
+    return MatrixView(matrix, size, size);
 }
-// Non-const index access operator: returns a proxy Row object.
-SquareMat::Row SquareMat::operator[](int row) {
-    if (row < 0 || row >= size) {
-        throw MatrixException("Row index out of bounds");
-    }
-    return Row(matrix + row * size);
+
+/// @brief Read-only view of the whole matrix
+ConstMatrixView SquareMat::view() const {
+    return ConstMatrixView(matrix, size, size);
 }
 
-// Const index access operator: returns a proxy ConstRow object.
-SquareMat::ConstRow SquareMat::operator[](int row) const {
-    if (row < 0 || row >= size) {
-        throw MatrixException("Row index out of bounds");
-    }
-    return ConstRow(matrix + row * size);
+/// @brief Mutable view of the n x n block starting at (row, col)
+MatrixView SquareMat::block(int row, int col, int n) {
+    return view().block(row, col, n);
 }
 
-// Implementation of Row's operator[]
-double& SquareMat::Row::operator[](int col) {
-    if (col < 0) {
-        throw MatrixException("Column index cannot be negative");
-    }
-    // Note: We assume the caller knows the matrix dimensions;
-    return rowData[col];
+/// @brief Read-only view of the n x n block starting at (row, col)
+ConstMatrixView SquareMat::block(int row, int col, int n) const {
+    return view().block(row, col, n);
 }
 
-// Implementation of ConstRow's operator[]
-const double& SquareMat::ConstRow::operator[](int col) const {
-    if (col < 0) {
-        throw MatrixException("Column index cannot be negative");
-    }
-    return rowData[col];
+SquareMat::operator MatrixView() {
+    return view();
+}
+
+SquareMat::operator ConstMatrixView() const {
+    return view();
 }
+
 /// @brief Element-wise addition assignment
 SquareMat& SquareMat::operator+=(const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Add, size, cells(size), cellBytes(size, 3));
     if (size != rhs.size) {
         throw MatrixException("Matrices must have the same dimensions for +=");
     }
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         matrix[i] += rhs.matrix[i];
     }
@@ -101,9 +201,11 @@ SquareMat& SquareMat::operator+=(const SquareMat& rhs) {
 
 /// @brief Element-wise subtraction assignment
 SquareMat& SquareMat::operator-=(const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Subtract, size, cells(size), cellBytes(size, 3));
     if (size != rhs.size) {
         throw MatrixException("Matrices must have the same dimensions for -=");
     }
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         matrix[i] -= rhs.matrix[i];
     }
@@ -112,25 +214,84 @@ SquareMat& SquareMat::operator-=(const SquareMat& rhs) {
 
 /// @brief Standard matrix multiplication assignment
 SquareMat& SquareMat::operator*=(const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Multiply, size, 2 * cells(size) * size, cellBytes(size, 3));
     if (size != rhs.size) {
         throw MatrixException("Matrices must have the same dimensions for multiplication");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            double sum = 0.0;
-            for (int k = 0; k < size; ++k) {
-                sum += matrix[i * size + k] * rhs.matrix[k * size + j];
-            }
-            result.matrix[i * size + j] = sum;
-        }
+    multiplyInPlace(false, rhs.matrix);
+    return *this;
+}
+
+/// @brief this = this * op(rhs). With distinct operands each output row only
+/// needs the same row of this, so panels of rows are computed into scratch and
+/// copied back. When rhs is our own buffer every row is needed until the end,
+/// and a shared buffer would need a private copy first: either way the product
+/// goes into a fresh buffer that replaces ours, with no copy-back.
+void SquareMat::multiplyInPlace(bool transRhs, const double* rhs) {
+    hashCache.store(HASH_UNSET, std::memory_order_relaxed);
+    if (rhs == matrix || isShared()) {
+        double* product = newBuffer(size);
+        detail::gemm(false, transRhs, size, size, size, 1.0, matrix, size, rhs, size, 0.0, product, size);
+        SQUAREMAT_OP_ALGORITHM("inplace-swap");  // after gemm, which labels the scope too
+        freeBuffer(matrix, size);
+        matrix = product;
+        return;
+    }
+    int panel = size < INPLACE_PANEL ? size : INPLACE_PANEL;
+    memory::Scratch panelBuffer(3, static_cast<std::uint64_t>(panel) * static_cast<std::uint64_t>(size));
+    double* rows = panelBuffer.data();
+    for (int r0 = 0; r0 < size; r0 += panel) {
+        int height = (size - r0 < panel) ? size - r0 : panel;
+        double* band = matrix + r0 * size;
+        detail::gemm(false, transRhs, height, size, size, 1.0, band, size, rhs, size, 0.0, rows, size);
+        std::copy(rows, rows + height * size, band);
+    }
+    SQUAREMAT_OP_ALGORITHM("inplace-row-panels");
+}
+
+/// @brief Addition assignment of a transpose, read in place
+SquareMat& SquareMat::operator+=(const TransposedMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Add, size, cells(size), cellBytes(size, 3));
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    if (&rhs.base() == this) {
+        // a += ~a would read entries it already overwrote
+        return *this += SquareMat(rhs);
     }
-    *this = result;
+    prepareWrite();
+    detail::geadd(false, true, size, 1.0, matrix, size, 1.0, rhs.base().matrix, size, matrix, size);
+    return *this;
+}
+
+/// @brief Subtraction assignment of a transpose, read in place
+SquareMat& SquareMat::operator-=(const TransposedMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Subtract, size, cells(size), cellBytes(size, 3));
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    if (&rhs.base() == this) {
+        return *this -= SquareMat(rhs);
+    }
+    prepareWrite();
+    detail::geadd(false, true, size, 1.0, matrix, size, -1.0, rhs.base().matrix, size, matrix, size);
+    return *this;
+}
+
+/// @brief Multiplication assignment by a transpose: this = this * rhs^T
+SquareMat& SquareMat::operator*=(const TransposedMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Multiply, size, 2 * cells(size) * size, cellBytes(size, 3));
+    if (size != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    multiplyInPlace(true, rhs.base().matrix);
     return *this;
 }
 
 /// @brief Scalar multiplication assignment
 SquareMat& SquareMat::operator*=(double scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, size, cells(size), cellBytes(size, 2));
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         matrix[i] *= scalar;
     }
@@ -139,9 +300,11 @@ SquareMat& SquareMat::operator*=(double scalar) {
 
 /// @brief Scalar division assignment
 SquareMat& SquareMat::operator/=(double scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarDivide, size, cells(size), cellBytes(size, 2));
     if (scalar == 0.0) {
         throw MatrixException("Division by zero");
     }
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         matrix[i] /= scalar;
     }
@@ -150,28 +313,78 @@ SquareMat& SquareMat::operator/=(double scalar) {
 
 /// @brief Element-wise multiplication assignment
 SquareMat& SquareMat::operator%=(const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(ElementwiseMultiply, size, cells(size), cellBytes(size, 3));
     if (size != rhs.size) {
         throw MatrixException("Matrices must have the same dimensions for element-wise multiplication");
     }
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         matrix[i] *= rhs.matrix[i];
     }
     return *this;
 }
 
-/// @brief Scalar modulo assignment
+// Exact fmod without the libm call. fmod(x, m) = copysign(fmod(|x|, |m|), x),
+// and for |x| < FMOD_EXACT_LIMIT with an integer |m| >= 1, q * |m| is an exact
+// double for the truncated quotient q, so |x| - q * |m| is exact too. x / m is
+// correctly rounded, so q is at most one off, and one fixup step each way
+// restores 0 <= r < |m| (also exactly). Elements are processed in chunks of
+// FMOD_CHUNK with branch-free selects so a chunk vectorizes; a chunk holding a
+// larger, infinite or NaN element falls back to std::fmod per element.
+static const double FMOD_EXACT_LIMIT = 4503599627370496.0;  // 2^52
+static const int FMOD_CHUNK = 8;
+
+/// @brief fmod(x, divisor) for |x| < FMOD_EXACT_LIMIT and an integer divisor >= 1
+static inline double exactFmod(double x, double divisor) {
+    double magnitude = std::fabs(x);
+    double quotient = magnitude / divisor;
+    // round to an integer by adding 2^52, then step down if that rounded up
+    double q = (quotient + FMOD_EXACT_LIMIT) - FMOD_EXACT_LIMIT;
+    q = q > quotient ? q - 1.0 : q;
+    double r = magnitude - q * divisor;
+    r = r < 0.0 ? r + divisor : r;
+    r = r >= divisor ? r - divisor : r;
+    return std::copysign(r, x);  // also gives -0 for negative multiples
+}
+
+/// @brief Scalar modulo assignment with exact std::fmod semantics
 SquareMat& SquareMat::operator%=(int mod) {
+    SQUAREMAT_OP_SCOPE(Modulo, size, cells(size), cellBytes(size, 2));
     if (mod == 0) {
         throw MatrixException("Modulo by zero is undefined");
     }
-    for (int i = 0; i < size * size; ++i) {
-        matrix[i] = std::fmod(matrix[i], static_cast<double>(mod));
+    prepareWrite();
+    double divisor = std::fabs(static_cast<double>(mod));
+    std::uint64_t total = cells(size);
+    std::uint64_t i = 0;
+    for (; i + FMOD_CHUNK <= total; i += FMOD_CHUNK) {
+        double* chunk = matrix + i;
+        bool exact = true;
+        for (int k = 0; k < FMOD_CHUNK; ++k) {
+            exact &= std::fabs(chunk[k]) < FMOD_EXACT_LIMIT;  // false for NaN
+        }
+        if (exact) {
+            for (int k = 0; k < FMOD_CHUNK; ++k) {
+                chunk[k] = exactFmod(chunk[k], divisor);
+            }
+        } else {
+            for (int k = 0; k < FMOD_CHUNK; ++k) {
+                chunk[k] = std::fmod(chunk[k], divisor);
+            }
+        }
+    }
+    for (; i < total; ++i) {
+        double value = matrix[i];
+        matrix[i] = std::fabs(value) < FMOD_EXACT_LIMIT ? exactFmod(value, divisor) : std::fmod(value, divisor);
     }
+    SQUAREMAT_OP_ALGORITHM("chunked-exact-fmod");
     return *this;
 }
 
 /// @brief Prefix increment: increases all elements by 1
 SquareMat& SquareMat::operator++() {
+    SQUAREMAT_OP_SCOPE(Increment, size, cells(size), cellBytes(size, 2));
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         ++matrix[i];
     }
@@ -180,6 +393,7 @@ SquareMat& SquareMat::operator++() {
 
 /// @brief Postfix increment: returns original matrix before increment
 SquareMat SquareMat::operator++(int) {
+    SQUAREMAT_OP_SCOPE(Increment, size, cells(size), cellBytes(size, 4));
     SquareMat temp(*this);
     ++(*this);
     return temp;
@@ -187,6 +401,8 @@ SquareMat SquareMat::operator++(int) {
 
 /// @brief Prefix decrement: decreases all elements by 1
 SquareMat& SquareMat::operator--() {
+    SQUAREMAT_OP_SCOPE(Decrement, size, cells(size), cellBytes(size, 2));
+    prepareWrite();
     for (int i = 0; i < size * size; ++i) {
         --matrix[i];
     }
@@ -195,6 +411,7 @@ SquareMat& SquareMat::operator--() {
 
 /// @brief Postfix decrement: returns original matrix before decrement
 SquareMat SquareMat::operator--(int) {
+    SQUAREMAT_OP_SCOPE(Decrement, size, cells(size), cellBytes(size, 4));
     SquareMat temp(*this);
     --(*this);
     return temp;
@@ -202,6 +419,7 @@ SquareMat SquareMat::operator--(int) {
 
 /// @brief Unary minus: returns new matrix with all elements negated
 SquareMat SquareMat::operator-() const {
+    SQUAREMAT_OP_SCOPE(Negate, size, cells(size), cellBytes(size, 2));
     SquareMat result(size);
     for (int i = 0; i < size * size; ++i) {
         result.matrix[i] = -matrix[i];
@@ -209,17 +427,25 @@ SquareMat SquareMat::operator-() const {
     return result;
 }
 
-/// @brief Transpose of the matrix
-SquareMat SquareMat::operator~() const {
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result.matrix[j * size + i] = matrix[i * size + j];
-        }
+/// @brief Transpose of the matrix: an O(1) view, materialized only on conversion to SquareMat
+TransposedMat SquareMat::operator~() const {
+    return TransposedMat(*this);
+}
+/// @brief LU-factors a scratch copy of an n x n buffer (see detail::luFactor);
+/// the caller releases the returned buffer with freeBuffer
+static double* factoredCopy(const double* data, int n, int& sign) {
+    double* lu = newBuffer(n);
+    for (int i = 0; i < n * n; ++i) {
+        lu[i] = data[i];
     }
-    return result;
+    sign = detail::luFactor(n, lu, n);
+    return lu;
 }
+
+/// @brief Determinant through a blocked LU factorization of a scratch copy:
+/// det = sign(P) * prod(diag(U)), about 2/3 n^3 flops
 double SquareMat::operator!() const {
+    SQUAREMAT_OP_SCOPE(Determinant, size, cells(size) * static_cast<std::uint64_t>(size) * 2 / 3, cellBytes(size, 2));
     if (size == 0) {
         throw MatrixException("Determinant undefined for 0x0 matrix.");}
 
@@ -229,34 +455,86 @@ double SquareMat::operator!() const {
     if (size == 2) {
         return matrix[0] * matrix[3] - matrix[1] * matrix[2]; }
 
-    double detVal = 0.0;
-    for (int col = 0; col < size; ++col) {
-        int reducedSize = size - 1;
-        double* tempData = new double[reducedSize * reducedSize];
-        int index = 0;
+    int sign = 0;
+    double* lu = factoredCopy(matrix, size, sign);
+    SQUAREMAT_OP_ALGORITHM("lu-blocked");  // after luFactor, whose gemm calls relabel the scope
 
-        for (int i = 1; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                if (j == col) continue;
-                tempData[index++] = matrix[i * size + j];
+    double detVal = static_cast<double>(sign);
+    if (sign != 0) {
+        for (int i = 0; i < size; ++i) {
+            detVal *= lu[i * size + i];
+        }
+    }
+    freeBuffer(lu, size);
+    return detVal;
+}
+
+/// @brief Sign and log|det| from the same LU pass as operator!, summing
+/// log|u_ii| instead of multiplying so the result cannot overflow or underflow
+LogDeterminant SquareMat::logDeterminant() const {
+    SQUAREMAT_OP_SCOPE(Determinant, size, cells(size) * static_cast<std::uint64_t>(size) * 2 / 3, cellBytes(size, 2));
+    if (size == 0) {
+        throw MatrixException("Determinant undefined for 0x0 matrix.");}
+
+    int sign = 0;
+    double* lu = factoredCopy(matrix, size, sign);
+    SQUAREMAT_OP_ALGORITHM("lu-blocked-log");
+
+    LogDeterminant result{static_cast<double>(sign), 0.0};
+    if (sign == 0) {
+        result.logAbs = -INFINITY;
+    } else {
+        for (int i = 0; i < size; ++i) {
+            double pivot = lu[i * size + i];
+            if (pivot < 0.0) {
+                result.sign = -result.sign;
             }
+            result.logAbs += std::log(std::fabs(pivot));
         }
-        SquareMat minor(reducedSize, tempData);
-        delete[] tempData;
+    }
+    freeBuffer(lu, size);
+    return result;
+}
 
-        double sign = (col % 2 == 0) ? 1.0 : -1.0;
-        detVal += sign * matrix[col] * (!minor);
+
+/// @brief Shared body of the two products: validates lengths and computes
+/// into a temporary when y overlaps x, since gemv needs distinct buffers
+static void matrixVector(bool transposed, int n, const double* data, std::span<const double> x, std::span<double> y) {
+    if (static_cast<int>(x.size()) != n || static_cast<int>(y.size()) != n) {
+        throw MatrixException("Vector length must match the matrix size");
+    }
+    const double* xBegin = x.data();
+    const double* yBegin = y.data();
+    if (xBegin < yBegin + n && yBegin < xBegin + n) {
+        memory::Scratch resultBuffer(0, static_cast<std::size_t>(n));
+        double* result = resultBuffer.data();
+        detail::gemv(transposed, n, 1.0, data, n, xBegin, 0.0, result);
+        std::copy(result, result + n, y.begin());
+        return;
     }
+    detail::gemv(transposed, n, 1.0, data, n, xBegin, 0.0, y.data());
+}
 
-    return detVal;
+void SquareMat::multiplyVector(std::span<const double> x, std::span<double> y) const {
+    SQUAREMAT_OP_SCOPE(MatrixVector, size, 2 * cells(size), cellBytes(size, 1));
+    SQUAREMAT_OP_ALGORITHM("gemv-row-dots");
+    matrixVector(false, size, matrix, x, y);
 }
 
+void SquareMat::multiplyVectorLeft(std::span<const double> x, std::span<double> y) const {
+    SQUAREMAT_OP_SCOPE(MatrixVector, size, 2 * cells(size), cellBytes(size, 1));
+    SQUAREMAT_OP_ALGORITHM("gemv-row-axpy");
+    matrixVector(true, size, matrix, x, y);
+}
 
 /// @brief Power operation using binary exponentiation
 SquareMat SquareMat::operator^(int power) const {
     if (power < 0) {
         throw MatrixException("Negative powers not supported");
     }
+    SQUAREMAT_OP_SCOPE(Power, size, powerMultiplies(power) * 2 * cells(size) * size,
+                       powerMultiplies(power) * cellBytes(size, 3));
+    SQUAREMAT_OP_ALGORITHM("binary-exponentiation");
     SquareMat result = SquareMat::identity(size);
     SquareMat base(*this);
     while (power > 0) {
@@ -271,31 +549,182 @@ SquareMat SquareMat::operator^(int power) const {
 
 /// @brief Equality comparison based on matrix sum
 bool SquareMat::operator==(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return sum() == other.sum();
 }
 
+// Comparisons walk the buffers in chunks of EQ_CHUNK: the mismatch flags of a
+// chunk are OR-ed without branching (so the chunk vectorizes) and the loop
+// stops at the first chunk with a mismatch.
+static const int EQ_CHUNK = 8;
+
+bool SquareMat::equals(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, cells(size), cellBytes(size, 2));
+    if (size != other.size) {
+        return false;
+    }
+    if (matrix == other.matrix) {
+        return true;
+    }
+    const double* a = matrix;
+    const double* b = other.matrix;
+    std::uint64_t total = cells(size);
+    std::uint64_t i = 0;
+    for (; i + EQ_CHUNK <= total; i += EQ_CHUNK) {
+        bool mismatch = false;
+        for (int k = 0; k < EQ_CHUNK; ++k) {
+            mismatch |= a[i + k] != b[i + k];
+        }
+        if (mismatch) {
+            return false;
+        }
+    }
+    for (; i < total; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Doubles mapped onto a monotonic integer line, so the distance between
+/// two finite values counts the representable doubles between them (-0 == +0)
+static std::uint64_t ulpDistance(double a, double b) {
+    auto ordered = [](double x) {
+        std::int64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+    };
+    std::int64_t ia = ordered(a);
+    std::int64_t ib = ordered(b);
+    return ia > ib ? static_cast<std::uint64_t>(ia) - static_cast<std::uint64_t>(ib)
+                   : static_cast<std::uint64_t>(ib) - static_cast<std::uint64_t>(ia);
+}
+
+static bool closeEnough(double a, double b, double absTol, double relTol, std::uint64_t maxUlps) {
+    double diff = std::fabs(a - b);
+    if (diff <= absTol || diff <= relTol * std::fmax(std::fabs(a), std::fabs(b))) {
+        return true;
+    }
+    // NaN fails every test above; keep it out of the ULP test as well
+    return maxUlps != 0 && !std::isnan(a) && !std::isnan(b) && ulpDistance(a, b) <= maxUlps;
+}
+
+bool SquareMat::approxEquals(const SquareMat& other, double absTol, double relTol, std::uint64_t maxUlps) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 3 * cells(size), cellBytes(size, 2));
+    if (size != other.size) {
+        return false;
+    }
+    if (matrix == other.matrix) {
+        return true;
+    }
+    const double* a = matrix;
+    const double* b = other.matrix;
+    std::uint64_t total = cells(size);
+    for (std::uint64_t i = 0; i < total; i += EQ_CHUNK) {
+        std::uint64_t end = (i + EQ_CHUNK < total) ? i + EQ_CHUNK : total;
+        // cheap tolerance screen over the chunk; the exact test only runs on failures
+        bool outside = false;
+        for (std::uint64_t k = i; k < end; ++k) {
+            double diff = std::fabs(a[k] - b[k]);
+            outside |= !(diff <= absTol || diff <= relTol * std::fmax(std::fabs(a[k]), std::fabs(b[k])));
+        }
+        if (!outside) {
+            continue;
+        }
+        for (std::uint64_t k = i; k < end; ++k) {
+            if (!closeEnough(a[k], b[k], absTol, relTol, maxUlps)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Hash constants (xxHash64 primes) and the murmur3 finalizer.
+static const std::uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ULL;
+static const std::uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+static std::uint64_t rotateLeft(std::uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static std::uint64_t finalizeHash(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/// @brief Bits of x with -0 folded onto +0 (x + 0.0 is +0 for either zero)
+static std::uint64_t hashBits(double x) {
+    double normalized = x + 0.0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &normalized, sizeof(bits));
+    return bits;
+}
+
+/// @brief xxHash64-style rounds over the raw buffer in four independent lanes,
+/// so consecutive elements do not wait on each other's multiply
+std::uint64_t SquareMat::hash() const {
+#if SQUAREMAT_HASH_CACHE
+    std::uint64_t cached = hashCache.load(std::memory_order_relaxed);
+    if (cached != HASH_UNSET) {
+        return cached;
+    }
+#endif
+    std::uint64_t lanes[4] = {HASH_PRIME1 + HASH_PRIME2, HASH_PRIME2, 0, 0 - HASH_PRIME1};
+    std::uint64_t total = cells(size);
+    std::uint64_t i = 0;
+    for (; i + 4 <= total; i += 4) {
+        for (int l = 0; l < 4; ++l) {
+            lanes[l] = rotateLeft(lanes[l] + hashBits(matrix[i + l]) * HASH_PRIME2, 31) * HASH_PRIME1;
+        }
+    }
+    std::uint64_t h = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) +
+                      rotateLeft(lanes[3], 18);
+    h ^= static_cast<std::uint64_t>(size) * HASH_PRIME1;
+    for (; i < total; ++i) {
+        h = rotateLeft(h ^ (hashBits(matrix[i]) * HASH_PRIME2), 27) * HASH_PRIME1;
+    }
+    h = finalizeHash(h);
+    h = h == HASH_UNSET ? HASH_UNSET + 1 : h;  // keep the sentinel free, cached or not
+#if SQUAREMAT_HASH_CACHE
+    hashCache.store(h, std::memory_order_relaxed);
+    writable.store(false, std::memory_order_relaxed);  // the next write must drop it
+#endif
+    return h;
+}
+
 /// @brief Inequality comparison based on matrix sum
 bool SquareMat::operator!=(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return !(*this == other);
 }
 
 /// @brief Less than comparison based on matrix sum
 bool SquareMat::operator<(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return sum() < other.sum();
 }
 
 /// @brief Greater than comparison based on matrix sum
 bool SquareMat::operator>(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return sum() > other.sum();
 }
 
 /// @brief Less than or equal comparison based on matrix sum
 bool SquareMat::operator<=(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return sum() <= other.sum();
 }
 
 /// @brief Greater than or equal comparison based on matrix sum
 bool SquareMat::operator>=(const SquareMat& other) const {
+    SQUAREMAT_OP_SCOPE(Compare, size, 2 * cells(size), cellBytes(size, 2));
     return sum() >= other.sum();
 }
 
@@ -312,6 +741,7 @@ std::ostream& operator<<(std::ostream& os, const SquareMat& mat) {
 
 /// @brief Creates an identity matrix of given size
 SquareMat SquareMat::identity(int n) {
+    SQUAREMAT_OP_SCOPE(Construct, n, 0, cellBytes(n, 1));
     SquareMat id(n);
     for (int i = 0; i < n; ++i) {
         id.matrix[i * n + i] = 1.0;
@@ -321,6 +751,7 @@ SquareMat SquareMat::identity(int n) {
 
 /// @brief Sums all elements in the matrix
 double SquareMat::sum() const {
+    SQUAREMAT_OP_SCOPE(Sum, size, cells(size), cellBytes(size, 1));
     double total = 0.0;
     for (int i = 0; i < size * size; ++i) {
         total += matrix[i];
@@ -333,44 +764,452 @@ int SquareMat::getSize() const {
     return size;
 }
 
+// Implementation of TransposedMat's column proxy
+const double& TransposedMat::ConstColumn::operator[](int col) const {
+    if (col < 0) {
+        throw MatrixException("Column index cannot be negative");
+    }
+    return colData[col * stride];
+}
+
+/// @brief Row `row` of the view is column `row` of the source
+TransposedMat::ConstColumn TransposedMat::operator[](int row) const {
+    if (row < 0 || row >= source->size) {
+        throw MatrixException("Row index out of bounds");
+    }
+    return ConstColumn(source->matrix + row, source->size);
+}
+
+/// @brief Transpose of a transpose is the source itself
+const SquareMat& TransposedMat::operator~() const {
+    return *source;
+}
+
+/// @brief Unary minus: materializes the transpose, then negates it
+SquareMat TransposedMat::operator-() const {
+    SquareMat result(*this);
+    return result *= -1.0;
+}
+
+/// @brief Determinant of the view equals the determinant of the source
+double TransposedMat::operator!() const {
+    return !(*source);
+}
+
+LogDeterminant TransposedMat::logDeterminant() const {
+    return source->logDeterminant();
+}
+
+/// @brief Power of the transpose: (A^T)^k, materialized once
+SquareMat TransposedMat::operator^(int power) const {
+    return SquareMat(*this) ^ power;
+}
+
+bool TransposedMat::operator==(const SquareMat& other) const {
+    return sum() == other.sum();
+}
+
+bool TransposedMat::operator!=(const SquareMat& other) const {
+    return !(*this == other);
+}
+
+bool TransposedMat::operator<(const SquareMat& other) const {
+    return sum() < other.sum();
+}
+
+bool TransposedMat::operator>(const SquareMat& other) const {
+    return sum() > other.sum();
+}
+
+bool TransposedMat::operator<=(const SquareMat& other) const {
+    return sum() <= other.sum();
+}
+
+bool TransposedMat::operator>=(const SquareMat& other) const {
+    return sum() >= other.sum();
+}
+
+/// @brief The same transpose as a generic strided view
+TransposedMat::operator ConstMatrixView() const {
+    return ConstMatrixView(source->matrix, source->size, source->size, true);
+}
+
+/// @brief The matrix this view transposes
+const SquareMat& TransposedMat::base() const {
+    return *source;
+}
+
+/// @brief Sum of all elements (same as the source's)
+double TransposedMat::sum() const {
+    return source->sum();
+}
+
+/// @brief Returns the matrix size
+int TransposedMat::getSize() const {
+    return source->size;
+}
+
+/// @brief Output stream operator, prints the transposed layout without copying
+std::ostream& operator<<(std::ostream& os, const TransposedMat& view) {
+    int n = view.getSize();
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            os << view[i][j] << " ";
+        }
+        os << '\n';
+    }
+    return os;
+}
+
 /// @brief External operator+: lhs + rhs
 SquareMat operator+(const SquareMat& lhs, const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Add, lhs.getSize(), cells(lhs.getSize()), cellBytes(lhs.getSize(), 3));
     return SquareMat(lhs) += rhs;
 }
 
 /// @brief External operator-: lhs - rhs
 SquareMat operator-(const SquareMat& lhs, const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(Subtract, lhs.getSize(), cells(lhs.getSize()), cellBytes(lhs.getSize(), 3));
     return SquareMat(lhs) -= rhs;
 }
 
 /// @brief External operator*: lhs * rhs (matrix multiplication)
 SquareMat operator*(const SquareMat& lhs, const SquareMat& rhs) {
-    return SquareMat(lhs) *= rhs;
+    SQUAREMAT_OP_SCOPE(Multiply, lhs.getSize(), 2 * cells(lhs.getSize()) * lhs.getSize(), cellBytes(lhs.getSize(), 3));
+    if (lhs.getSize() != rhs.getSize()) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    // straight into the result: no copy of lhs for an in-place multiply to overwrite
+    SquareMat result(lhs.getSize());
+    multiply(result, lhs, rhs);
+    return result;
 }
 
 /// @brief External operator*: matrix * scalar
 SquareMat operator*(const SquareMat& mat, double scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, mat.getSize(), cells(mat.getSize()), cellBytes(mat.getSize(), 2));
     return SquareMat(mat) *= scalar;
 }
 
 /// @brief External operator*: scalar * matrix
 SquareMat operator*(double scalar, const SquareMat& mat) {
-    return mat * scalar;
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, mat.getSize(), cells(mat.getSize()), cellBytes(mat.getSize(), 2));
+    return SquareMat(mat) *= scalar;
+}
+
+/// @brief External operator*: matrix * column vector
+std::vector<double> operator*(const SquareMat& mat, std::span<const double> x) {
+    std::vector<double> y(mat.getSize());
+    mat.multiplyVector(x, y);
+    return y;
+}
+
+/// @brief External operator*: row vector * matrix, returned as a plain vector
+std::vector<double> operator*(std::span<const double> x, const SquareMat& mat) {
+    std::vector<double> y(mat.getSize());
+    mat.multiplyVectorLeft(x, y);
+    return y;
+}
+
+/// @brief Fused multiply-accumulate straight into c's buffer through the shared kernel
+void gemm(double alpha, const SquareMat& a, const SquareMat& b, double beta, SquareMat& c,
+          bool transA, bool transB) {
+    int n = c.getSize();
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * cells(n) * static_cast<std::uint64_t>(n) + 2 * cells(n), cellBytes(n, 4));
+    if (a.getSize() != n || b.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    if (&c != &a && &c != &b) {
+        detail::gemm(transA, transB, n, n, n, alpha, a.data(), n, b.data(), n, beta, c.data(), n);
+        return;
+    }
+    // the kernel must not read what it is writing: multiply into a temporary,
+    // then C = product + beta * C (geadd may alias an untransposed operand)
+    SquareMat product(n);
+    detail::gemm(transA, transB, n, n, n, alpha, a.data(), n, b.data(), n, 0.0, product.data(), n);
+    detail::geadd(false, false, n, 1.0, product.data(), n, beta, c.data(), n, c.data(), n);
+}
+
+static void checkDestination(const SquareMat& dst, int n) {
+    if (dst.getSize() != n) {
+        throw MatrixException("Destination must have the same dimensions as the operands");
+    }
+}
+
+void add(SquareMat& dst, const SquareMat& a, const SquareMat& b) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(Add, n, cells(n), cellBytes(n, 3));
+    if (b.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    checkDestination(dst, n);
+    detail::geadd(false, false, n, 1.0, a.data(), n, 1.0, b.data(), n, dst.data(), n);
+}
+
+void subtract(SquareMat& dst, const SquareMat& a, const SquareMat& b) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(Subtract, n, cells(n), cellBytes(n, 3));
+    if (b.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    checkDestination(dst, n);
+    detail::geadd(false, false, n, 1.0, a.data(), n, -1.0, b.data(), n, dst.data(), n);
+}
+
+void multiply(SquareMat& dst, const SquareMat& a, const SquareMat& b) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * cells(n) * n, cellBytes(n, 3));
+    if (b.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    checkDestination(dst, n);
+    if (&dst != &a && &dst != &b) {
+        detail::gemm(false, false, n, n, n, 1.0, a.data(), n, b.data(), n, 0.0, dst.data(), n);
+        return;
+    }
+    memory::Scratch product(0, cells(n));
+    detail::gemm(false, false, n, n, n, 1.0, a.data(), n, b.data(), n, 0.0, product.data(), n);
+    std::copy(product.data(), product.data() + cells(n), dst.data());
+}
+
+void multiply(SquareMat& dst, const SquareMat& a, double scalar) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, n, cells(n), cellBytes(n, 2));
+    checkDestination(dst, n);
+    const double* src = a.data();
+    double* out = dst.data();
+    for (std::uint64_t i = 0; i < cells(n); ++i) {
+        out[i] = src[i] * scalar;
+    }
+}
+
+void divide(SquareMat& dst, const SquareMat& a, double scalar) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(ScalarDivide, n, cells(n), cellBytes(n, 2));
+    if (scalar == 0.0) {
+        throw MatrixException("Division by zero");
+    }
+    checkDestination(dst, n);
+    const double* src = a.data();
+    double* out = dst.data();
+    for (std::uint64_t i = 0; i < cells(n); ++i) {
+        out[i] = src[i] / scalar;
+    }
+}
+
+void negate(SquareMat& dst, const SquareMat& a) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(Negate, n, cells(n), cellBytes(n, 2));
+    checkDestination(dst, n);
+    const double* src = a.data();
+    double* out = dst.data();
+    for (std::uint64_t i = 0; i < cells(n); ++i) {
+        out[i] = -src[i];
+    }
+}
+
+void transpose(SquareMat& dst, const SquareMat& a) {
+    int n = a.getSize();
+    SQUAREMAT_OP_SCOPE(Transpose, n, 0, cellBytes(n, 2));
+    checkDestination(dst, n);
+    if (&dst != &a) {
+        detail::transpose(n, a.data(), n, dst.data(), n);
+        return;
+    }
+    // square in-place transpose: swap across the diagonal
+    double* data = dst.data();
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            double tmp = data[i * n + j];
+            data[i * n + j] = data[j * n + i];
+            data[j * n + i] = tmp;
+        }
+    }
+}
+
+/// @brief Binary exponentiation that ping-pongs between dst and scratch buffers
+/// instead of allocating; the first combine copies instead of multiplying by I
+void power(SquareMat& dst, const SquareMat& a, int k) {
+    int n = a.getSize();
+    if (k < 0) {
+        throw MatrixException("Negative powers not supported");
+    }
+    SQUAREMAT_OP_SCOPE(Power, n, powerMultiplies(k) * 2 * cells(n) * n, powerMultiplies(k) * cellBytes(n, 3));
+    SQUAREMAT_OP_ALGORITHM("binary-exponentiation");
+    checkDestination(dst, n);
+    if (k <= 1) {
+        // a copy or the identity needs no scratch
+        if (k == 0) {
+            double* out = dst.data();
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    out[i * n + j] = (i == j) ? 1.0 : 0.0;
+                }
+            }
+        } else if (&dst != &a) {
+            std::copy(a.data(), a.data() + cells(n), dst.data());
+        }
+        return;
+    }
+    memory::Scratch baseBuffer(0, cells(n));
+    memory::Scratch baseSpareBuffer(1, cells(n));
+    memory::Scratch spareBuffer(2, cells(n));
+    double* base = baseBuffer.data();
+    double* baseSpare = baseSpareBuffer.data();
+    double* spare = spareBuffer.data();
+    std::copy(a.data(), a.data() + cells(n), base);  // before dst is touched, dst may be a
+
+    double* result = dst.data();
+    bool identity = true;
+    while (k > 0) {
+        if (k % 2 == 1) {
+            if (identity) {
+                std::copy(base, base + cells(n), result);
+                identity = false;
+            } else {
+                detail::gemm(false, false, n, n, n, 1.0, result, n, base, n, 0.0, spare, n);
+                std::swap(result, spare);
+            }
+        }
+        k /= 2;
+        if (k > 0) {
+            detail::gemm(false, false, n, n, n, 1.0, base, n, base, n, 0.0, baseSpare, n);
+            std::swap(base, baseSpare);
+        }
+    }
+    if (result != dst.data()) {
+        std::copy(result, result + cells(n), dst.data());
+    }
 }
 
 /// @brief External operator/: matrix / scalar
 SquareMat operator/(const SquareMat& mat, double scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarDivide, mat.getSize(), cells(mat.getSize()), cellBytes(mat.getSize(), 2));
     return SquareMat(mat) /= scalar;
 }
 
 /// @brief External operator%: lhs % rhs (element-wise multiplication)
 SquareMat operator%(const SquareMat& lhs, const SquareMat& rhs) {
+    SQUAREMAT_OP_SCOPE(ElementwiseMultiply, lhs.getSize(), cells(lhs.getSize()), cellBytes(lhs.getSize(), 3));
     return SquareMat(lhs) %= rhs;
 }
 
 /// @brief External operator%: matrix % scalar
 SquareMat operator%(const SquareMat& mat, int mod) {
+    SQUAREMAT_OP_SCOPE(Modulo, mat.getSize(), cells(mat.getSize()), cellBytes(mat.getSize(), 2));
     return SquareMat(mat) %= mod;
 }
 
+/// @brief External operator*: lhs^T * rhs, lhs read in place
+SquareMat operator*(const TransposedMat& lhs, const SquareMat& rhs) {
+    int n = rhs.size;
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * cells(n) * n, cellBytes(n, 3));
+    if (lhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    SquareMat result(n);
+    detail::gemm(true, false, n, n, n, 1.0, lhs.base().matrix, n, rhs.matrix, n, 0.0, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator*: lhs * rhs^T, rhs read in place
+SquareMat operator*(const SquareMat& lhs, const TransposedMat& rhs) {
+    int n = lhs.size;
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * cells(n) * n, cellBytes(n, 3));
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    SquareMat result(n);
+    detail::gemm(false, true, n, n, n, 1.0, lhs.matrix, n, rhs.base().matrix, n, 0.0, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator*: lhs^T * rhs^T, both read in place
+SquareMat operator*(const TransposedMat& lhs, const TransposedMat& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Multiply, n, 2 * cells(n) * n, cellBytes(n, 3));
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    SquareMat result(n);
+    detail::gemm(true, true, n, n, n, 1.0, lhs.base().matrix, n, rhs.base().matrix, n, 0.0, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator*: transpose * scalar
+SquareMat operator*(const TransposedMat& view, double scalar) {
+    SQUAREMAT_OP_SCOPE(ScalarMultiply, view.getSize(), cells(view.getSize()), cellBytes(view.getSize(), 2));
+    return SquareMat(view) *= scalar;
+}
+
+/// @brief External operator*: scalar * transpose
+SquareMat operator*(double scalar, const TransposedMat& view) {
+    return view * scalar;
+}
+
+/// @brief External operator+: lhs^T + rhs in a single pass
+SquareMat operator+(const TransposedMat& lhs, const SquareMat& rhs) {
+    int n = rhs.size;
+    SQUAREMAT_OP_SCOPE(Add, n, cells(n), cellBytes(n, 3));
+    if (lhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    SquareMat result(n);
+    detail::geadd(true, false, n, 1.0, lhs.base().matrix, n, 1.0, rhs.matrix, n, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator+: lhs + rhs^T in a single pass
+SquareMat operator+(const SquareMat& lhs, const TransposedMat& rhs) {
+    return rhs + lhs;
+}
+
+/// @brief External operator+: lhs^T + rhs^T in a single pass
+SquareMat operator+(const TransposedMat& lhs, const TransposedMat& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Add, n, cells(n), cellBytes(n, 3));
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    SquareMat result(n);
+    detail::geadd(true, true, n, 1.0, lhs.base().matrix, n, 1.0, rhs.base().matrix, n, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator-: lhs^T - rhs in a single pass
+SquareMat operator-(const TransposedMat& lhs, const SquareMat& rhs) {
+    int n = rhs.size;
+    SQUAREMAT_OP_SCOPE(Subtract, n, cells(n), cellBytes(n, 3));
+    if (lhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    SquareMat result(n);
+    detail::geadd(true, false, n, 1.0, lhs.base().matrix, n, -1.0, rhs.matrix, n, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator-: lhs - rhs^T in a single pass
+SquareMat operator-(const SquareMat& lhs, const TransposedMat& rhs) {
+    int n = lhs.size;
+    SQUAREMAT_OP_SCOPE(Subtract, n, cells(n), cellBytes(n, 3));
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    SquareMat result(n);
+    detail::geadd(false, true, n, 1.0, lhs.matrix, n, -1.0, rhs.base().matrix, n, result.matrix, n);
+    return result;
+}
+
+/// @brief External operator-: lhs^T - rhs^T in a single pass
+SquareMat operator-(const TransposedMat& lhs, const TransposedMat& rhs) {
+    int n = lhs.getSize();
+    SQUAREMAT_OP_SCOPE(Subtract, n, cells(n), cellBytes(n, 3));
+    if (rhs.getSize() != n) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    SquareMat result(n);
+    detail::geadd(true, true, n, 1.0, lhs.base().matrix, n, -1.0, rhs.base().matrix, n, result.matrix, n);
+    return result;
+}
+
 } // namespace matrix
@@ -2,7 +2,33 @@
 #ifndef SQUARMAT_HPP
 #define SQUARMAT_HPP
 
+#include "MatrixIterators.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <span>
+#include <vector>
+
+// Bounds-checking policy for element access. Checks are on by default and
+// compiled out when NDEBUG is defined; define SQUAREMAT_CHECK_BOUNDS to 0 or 1
+// before including this header to override either way.
+#ifndef SQUAREMAT_CHECK_BOUNDS
+#ifdef NDEBUG
+#define SQUAREMAT_CHECK_BOUNDS 0
+#else
+#define SQUAREMAT_CHECK_BOUNDS 1
+#endif
+#endif
+
+// Content-hash caching. With SQUAREMAT_HASH_CACHE=1, hash() remembers its
+// result until the matrix is next modified through its own API (every
+// non-const accessor and mutating operator drops it). Writes through a pointer,
+// span or view obtained *before* the hash() call are not seen, hence opt-in.
+#ifndef SQUAREMAT_HASH_CACHE
+#define SQUAREMAT_HASH_CACHE 0
+#endif
 
 namespace matrix {
 
@@ -12,12 +38,46 @@ class MatrixException {
         explicit MatrixException(const char* m) : msg(m) {}
     };
 
+/// @brief det = sign * exp(logAbs); sign is 0 (and logAbs -inf) for a singular matrix.
+struct LogDeterminant {
+    double sign;
+    double logAbs;
+};
+
+class LowRankMat;
+class TransposedMat;
+class MatrixView;
+class ConstMatrixView;
+
 class SquareMat {
 private:
     int size;
     double* matrix;
+    // Cached hash() result, or HASH_UNSET. One atomic word, so concurrent
+    // const readers (and copies made from them) may fill and read it freely:
+    // every writer stores the same value for the same contents.
+    static const std::uint64_t HASH_UNSET = 0;
+    mutable std::atomic<std::uint64_t> hashCache{HASH_UNSET};
+
+    // Buffers are reference counted and shared by copies (copy-on-write);
+    // prepareWrite() runs after the arguments are validated and before the
+    // first write, and gives this matrix a private buffer if it is shared. `writable` records
+    // that the buffer is private and the hash cache clear, so repeated writes
+    // cost one flag test; sharing the buffer (copying from this matrix) and
+    // caching a hash reset it. Atomic only because const copies and hash()
+    // may reset it from concurrent readers.
+    mutable std::atomic<bool> writable{false};
+    bool isShared() const;
+    void detach();
+    void makeWritable();
+    void prepareWrite() {
+        if (!writable.load(std::memory_order_relaxed)) {
+            makeWritable();
+        }
+    }
+    void multiplyInPlace(bool transRhs, const double* rhs);
 
-    void copyMem(const SquareMat& other);
+    friend class TransposedMat;
 
 public:
     
@@ -25,6 +85,8 @@ public:
     SquareMat(int n);
     SquareMat(int size, const double* initData);
     SquareMat(const SquareMat& other);
+    SquareMat(const TransposedMat& view);  // materializes a lazy transpose
+    explicit SquareMat(const ConstMatrixView& view);  // copies a block out
     SquareMat& operator=(const SquareMat& other);
     ~SquareMat();
 
@@ -34,10 +96,16 @@ public:
     SquareMat operator++(int);
     SquareMat& operator--();
     SquareMat operator--(int);
-    SquareMat operator~() const;
+    TransposedMat operator~() const;  // O(1) view, see TransposedMat
     double operator!() const;
+    LogDeterminant logDeterminant() const;  // no overflow/underflow for large n
     SquareMat operator^(int power) const;
 
+    // Matrix-vector products in O(n^2), without building a matrix from the vector.
+    // x and y must have getSize() elements; y may alias x.
+    void multiplyVector(std::span<const double> x, std::span<double> y) const;      // y = m * x
+    void multiplyVectorLeft(std::span<const double> x, std::span<double> y) const;  // y^T = x^T * m
+
     // Equality and comparisons
     bool operator==(const SquareMat& other) const;
     bool operator!=(const SquareMat& other) const;
@@ -46,6 +114,19 @@ public:
     bool operator<=(const SquareMat& other) const;
     bool operator>=(const SquareMat& other) const;
 
+    // Element-wise checks (the operators above only compare sums). Different
+    // sizes compare unequal. equals() is IEEE ==, so -0 equals +0 and NaN never
+    // matches, except that a matrix always (approx)equals itself: the same
+    // buffer is accepted without reading it.
+    bool equals(const SquareMat& other) const;
+    /// @brief Every pair within absTol, or within relTol of the larger
+    /// magnitude, or at most maxUlps representable doubles apart; NaN never matches.
+    bool approxEquals(const SquareMat& other, double absTol, double relTol = 0.0, std::uint64_t maxUlps = 0) const;
+
+    /// @brief 64-bit hash of size and contents, consistent with equals():
+    /// -0 and +0 hash alike. Never 0. Cached when SQUAREMAT_HASH_CACHE is on.
+    std::uint64_t hash() const;
+
     // Compound assignment
     SquareMat& operator+=(const SquareMat& rhs);
     SquareMat& operator-=(const SquareMat& rhs);
@@ -54,35 +135,265 @@ public:
     SquareMat& operator/=(double scalar);
     SquareMat& operator%=(const SquareMat& rhs);
     SquareMat& operator%=(int mod);
+    SquareMat& operator+=(const TransposedMat& rhs);
+    SquareMat& operator-=(const TransposedMat& rhs);
+    SquareMat& operator*=(const TransposedMat& rhs);
+    SquareMat& operator+=(const LowRankMat& rhs);  // O(n^2 k), see LowRankMat.cpp
+    SquareMat& operator-=(const LowRankMat& rhs);
 
     class Row {
         private:
             double* rowData;
+            int cols;
         public:
-            explicit Row(double* data) : rowData(data) {}
-            double& operator[](int col);  // Provide modifiable access (bounds checking in implementation)
+            Row(double* data, int cols) : rowData(data), cols(cols) {}
+            double& operator[](int col);  // Provide modifiable access (checked per SQUAREMAT_CHECK_BOUNDS)
         };
 
     class ConstRow {
         private:
             const double* rowData;
+            int cols;
         public:
-            explicit ConstRow(const double* data) : rowData(data) {}
+            ConstRow(const double* data, int cols) : rowData(data), cols(cols) {}
             const double& operator[](int col) const;
         };
 
-    // Non-const access.
+    // Non-const access. Like every non-const accessor below, it first gives a
+    // shared (copied) matrix its own buffer, once per sharing rather than per
+    // call, so prefer const access for reads of a copy. Rows, pointers, spans
+    // and views obtained this way write to the current buffer: re-obtain them
+    // after the matrix has been copied.
     Row operator[](int row);
     // Const access.
     ConstRow operator[](int row) const;
 
+    // Row i as a contiguous span; the index is checked per SQUAREMAT_CHECK_BOUNDS
+    // and the non-const form detaches a shared buffer first, like operator[].
+    std::span<double> row(int i);
+    std::span<const double> row(int i) const;
+    // Whole buffer, row-major: row i is data()[i * size, (i + 1) * size). Never
+    // checked; tight loops should take this pointer once, outside the loop.
+    double* data();
+    const double* data() const;
+
+    // STL iteration. Elements are visited in row-major order through plain
+    // pointers; rows() yields std::span rows and columns()/column(j) strided ranges.
+    double* begin();
+    double* end();
+    const double* begin() const;
+    const double* end() const;
+    RowRange<double> rows();
+    RowRange<const double> rows() const;
+    ColumnRange<double> columns();
+    ColumnRange<const double> columns() const;
+    StridedRange<double> column(int j);
+    StridedRange<const double> column(int j) const;
+
+    // Non-owning views (see MatrixView.hpp); valid while this matrix is alive and not resized.
+    MatrixView view();
+    ConstMatrixView view() const;
+    MatrixView block(int row, int col, int n);
+    ConstMatrixView block(int row, int col, int n) const;
+    operator MatrixView();
+    operator ConstMatrixView() const;
+
 
     friend std::ostream& operator<<(std::ostream& os, const SquareMat& mat);
+    friend SquareMat operator*(const TransposedMat& lhs, const SquareMat& rhs);
+    friend SquareMat operator*(const SquareMat& lhs, const TransposedMat& rhs);
+    friend SquareMat operator*(const TransposedMat& lhs, const TransposedMat& rhs);
+    friend SquareMat operator+(const TransposedMat& lhs, const SquareMat& rhs);
+    friend SquareMat operator+(const TransposedMat& lhs, const TransposedMat& rhs);
+    friend SquareMat operator-(const TransposedMat& lhs, const SquareMat& rhs);
+    friend SquareMat operator-(const SquareMat& lhs, const TransposedMat& rhs);
+    friend SquareMat operator-(const TransposedMat& lhs, const TransposedMat& rhs);
     static SquareMat identity(int n);
     double sum() const;
     int getSize()const;
 };
 
+/// @brief Lazy transpose returned by SquareMat::operator~.
+/// Holds only a pointer to its source: indexing reads the source in transposed
+/// order and the multiplication/addition kernels consume the layout directly,
+/// so `~a * b` never copies `a`. Converting to SquareMat materializes an owning
+/// copy. The view must not outlive its source (avoid `auto t = ~(a * b);`).
+class TransposedMat {
+private:
+    const SquareMat* source;
+
+public:
+    explicit TransposedMat(const SquareMat& src) : source(&src) {}
+
+    class ConstColumn {
+        private:
+            const double* colData;
+            int stride;
+        public:
+            ConstColumn(const double* data, int step) : colData(data), stride(step) {}
+            const double& operator[](int col) const;
+        };
+
+    // Element (row, col) of the view is element (col, row) of the source.
+    ConstColumn operator[](int row) const;
+
+    const SquareMat& operator~() const;  // ~~a is a again, no copy
+    SquareMat operator-() const;
+    double operator!() const;             // det(A^T) == det(A)
+    LogDeterminant logDeterminant() const;
+    SquareMat operator^(int power) const;
+
+    // Comparisons are sum-based like SquareMat's; the sum of a transpose is the source's sum
+    bool operator==(const SquareMat& other) const;
+    bool operator!=(const SquareMat& other) const;
+    bool operator<(const SquareMat& other) const;
+    bool operator>(const SquareMat& other) const;
+    bool operator<=(const SquareMat& other) const;
+    bool operator>=(const SquareMat& other) const;
+
+    const SquareMat& base() const;
+    double sum() const;
+    int getSize() const;
+    operator ConstMatrixView() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const TransposedMat& view);
+};
+
+// Element access is defined inline so it folds into callers' loops; with
+// SQUAREMAT_CHECK_BOUNDS == 0 a const access is a single address computation
+// and a non-const one adds a test of the `writable` flag (see prepareWrite).
+
+inline double& SquareMat::Row::operator[](int col) {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (col < 0) {
+        throw MatrixException("Column index cannot be negative");
+    }
+    if (col >= cols) {
+        throw MatrixException("Column index out of bounds");
+    }
+#endif
+    return rowData[col];
+}
+
+inline const double& SquareMat::ConstRow::operator[](int col) const {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (col < 0) {
+        throw MatrixException("Column index cannot be negative");
+    }
+    if (col >= cols) {
+        throw MatrixException("Column index out of bounds");
+    }
+#endif
+    return rowData[col];
+}
+
+inline bool SquareMat::isShared() const {
+    // the reference count sits in the slot in front of the elements (see newBuffer)
+    return reinterpret_cast<const std::atomic<std::int64_t>*>(matrix - 1)->load(std::memory_order_acquire) > 1;
+}
+
+inline SquareMat::Row SquareMat::operator[](int row) {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (row < 0 || row >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+#endif
+    prepareWrite();
+    return Row(matrix + row * size, size);
+}
+
+inline SquareMat::ConstRow SquareMat::operator[](int row) const {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (row < 0 || row >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+#endif
+    return ConstRow(matrix + row * size, size);
+}
+
+inline std::span<double> SquareMat::row(int i) {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (i < 0 || i >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+#endif
+    prepareWrite();
+    return std::span<double>(matrix + i * size, size);
+}
+
+inline std::span<const double> SquareMat::row(int i) const {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (i < 0 || i >= size) {
+        throw MatrixException("Row index out of bounds");
+    }
+#endif
+    return std::span<const double>(matrix + i * size, size);
+}
+
+inline double* SquareMat::data() {
+    prepareWrite();
+    return matrix;
+}
+
+inline const double* SquareMat::data() const {
+    return matrix;
+}
+
+inline double* SquareMat::begin() {
+    prepareWrite();
+    return matrix;
+}
+
+inline double* SquareMat::end() {
+    prepareWrite();
+    return matrix + size * size;
+}
+
+inline const double* SquareMat::begin() const {
+    return matrix;
+}
+
+inline const double* SquareMat::end() const {
+    return matrix + size * size;
+}
+
+inline RowRange<double> SquareMat::rows() {
+    prepareWrite();
+    return RowRange<double>(matrix, size);
+}
+
+inline RowRange<const double> SquareMat::rows() const {
+    return RowRange<const double>(matrix, size);
+}
+
+inline ColumnRange<double> SquareMat::columns() {
+    prepareWrite();
+    return ColumnRange<double>(matrix, size);
+}
+
+inline ColumnRange<const double> SquareMat::columns() const {
+    return ColumnRange<const double>(matrix, size);
+}
+
+inline StridedRange<double> SquareMat::column(int j) {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (j < 0 || j >= size) {
+        throw MatrixException("Column index out of bounds");
+    }
+#endif
+    prepareWrite();
+    return StridedRange<double>(matrix + j, size, size);
+}
+
+inline StridedRange<const double> SquareMat::column(int j) const {
+#if SQUAREMAT_CHECK_BOUNDS
+    if (j < 0 || j >= size) {
+        throw MatrixException("Column index out of bounds");
+    }
+#endif
+    return StridedRange<const double>(matrix + j, size, size);
+}
+
 // Binary operators (defined outside the class)
 SquareMat operator+(const SquareMat& lhs, const SquareMat& rhs);
 SquareMat operator-(const SquareMat& lhs, const SquareMat& rhs);
@@ -92,7 +403,61 @@ SquareMat operator*(double scalar, const SquareMat& mat);
 SquareMat operator/(const SquareMat& mat, double scalar);
 SquareMat operator%(const SquareMat& lhs, const SquareMat& rhs);
 SquareMat operator%(const SquareMat& mat, int mod);
+std::vector<double> operator*(const SquareMat& mat, std::span<const double> x);  // m * x
+std::vector<double> operator*(std::span<const double> x, const SquareMat& mat);  // x^T * m
+
+/// @brief Fused update C = alpha * op(A) * op(B) + beta * C in place, where op(X)
+/// is X or X^T per flag. Allocates nothing unless C is also A or B, in which
+/// case the product goes through one temporary first.
+void gemm(double alpha, const SquareMat& a, const SquareMat& b, double beta, SquareMat& c,
+          bool transA = false, bool transB = false);
+
+// Output-parameter forms of the operators: the result is written into dst,
+// which must already have the operands' size (MatrixException otherwise), so
+// loops can reuse one destination instead of allocating a result per call.
+// Aliasing: dst may be any of the operands in every function. Aliased
+// multiply and every power stage through per-thread scratch buffers
+// (memory::Scratch, counted against the budget) kept between calls up to
+// memory::scratchRetention(), and transpose(a, a) swaps in place, so
+// steady-state use below that size allocates nothing.
+void add(SquareMat& dst, const SquareMat& a, const SquareMat& b);
+void subtract(SquareMat& dst, const SquareMat& a, const SquareMat& b);
+void multiply(SquareMat& dst, const SquareMat& a, const SquareMat& b);
+void multiply(SquareMat& dst, const SquareMat& a, double scalar);
+void divide(SquareMat& dst, const SquareMat& a, double scalar);
+void negate(SquareMat& dst, const SquareMat& a);
+void transpose(SquareMat& dst, const SquareMat& a);
+void power(SquareMat& dst, const SquareMat& a, int k);
+
+// Transposed operands are read in place by the kernels
+SquareMat operator*(const TransposedMat& lhs, const SquareMat& rhs);
+SquareMat operator*(const SquareMat& lhs, const TransposedMat& rhs);
+SquareMat operator*(const TransposedMat& lhs, const TransposedMat& rhs);
+SquareMat operator*(const TransposedMat& view, double scalar);
+SquareMat operator*(double scalar, const TransposedMat& view);
+SquareMat operator+(const TransposedMat& lhs, const SquareMat& rhs);
+SquareMat operator+(const SquareMat& lhs, const TransposedMat& rhs);
+SquareMat operator+(const TransposedMat& lhs, const TransposedMat& rhs);
+SquareMat operator-(const TransposedMat& lhs, const SquareMat& rhs);
+SquareMat operator-(const SquareMat& lhs, const TransposedMat& rhs);
+SquareMat operator-(const TransposedMat& lhs, const TransposedMat& rhs);
+
+/// @brief Content equality for hashed containers, e.g.
+/// std::unordered_map<SquareMat, V, std::hash<SquareMat>, ContentEqual>;
+/// the default std::equal_to would use the sum-based operator==.
+struct ContentEqual {
+    bool operator()(const SquareMat& lhs, const SquareMat& rhs) const {
+        return lhs.equals(rhs);
+    }
+};
 
 } // namespace matrix
 
+template <>
+struct std::hash<matrix::SquareMat> {
+    std::size_t operator()(const matrix::SquareMat& mat) const {
+        return static_cast<std::size_t>(mat.hash());
+    }
+};
+
 #endif // SQUARMAT_HPP
@@ -0,0 +1,337 @@
+//agassinoa20@gmail.com
+#include "Stats.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace matrix {
+namespace stats {
+
+static const int OP_COUNT = static_cast<int>(Op::Count);
+
+// Global counters use relaxed atomics: each field is independent and a
+// snapshot only needs every field to be individually consistent.
+struct AtomicCounters {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> nanos{0};
+    std::atomic<std::uint64_t> flops{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocatedBytes{0};
+};
+
+static AtomicCounters globalCounters[OP_COUNT][BUCKET_COUNT];
+
+// Scope stack of the current thread: the innermost scope links to its parent,
+// and the outermost one is the operation the user actually called.
+static thread_local OpScope* innermost = nullptr;
+static thread_local int scopeDepth = 0;
+static thread_local Op currentOp = Op::Construct;
+static thread_local int currentSize = 0;
+
+// Latency histograms are per thread so recording never contends: the owning
+// thread is the only writer of its counters and bumps them with a relaxed
+// load + store instead of a locked read-modify-write. Readers merge every
+// thread's counters; the registry keeps them alive after their thread exits.
+// The bucket arrays (9 KiB each) are only allocated for pairs that occur.
+struct ThreadLatency {
+    std::atomic<std::atomic<std::uint64_t>*> slots[OP_COUNT][BUCKET_COUNT];
+    std::vector<std::unique_ptr<std::atomic<std::uint64_t>[]>> owned;
+
+    ThreadLatency() {
+        for (int o = 0; o < OP_COUNT; ++o) {
+            for (int b = 0; b < BUCKET_COUNT; ++b) {
+                slots[o][b].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+static std::mutex latencyMutex;
+static std::vector<std::shared_ptr<ThreadLatency>> latencyRegistry;
+
+static ThreadLatency& localLatency() {
+    static thread_local std::shared_ptr<ThreadLatency> local;
+    if (!local) {
+        local = std::make_shared<ThreadLatency>();
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        latencyRegistry.push_back(local);
+    }
+    return *local;
+}
+
+static std::vector<std::shared_ptr<ThreadLatency>> latencyThreads() {
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    return latencyRegistry;
+}
+
+static void mergeLatency(LatencyHistogram& result, const std::vector<std::shared_ptr<ThreadLatency>>& threads,
+                         int op, int bucket) {
+    for (const std::shared_ptr<ThreadLatency>& thread : threads) {
+        const std::atomic<std::uint64_t>* counts = thread->slots[op][bucket].load(std::memory_order_acquire);
+        if (counts == nullptr) {
+            continue;
+        }
+        for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+            std::uint64_t count = counts[i].load(std::memory_order_relaxed);
+            if (count != 0) {
+                result.recordCount(i, count);
+            }
+        }
+    }
+}
+
+static const char* const OP_NAMES[OP_COUNT] = {
+    "construct", "copy", "add", "subtract", "multiply", "scalar_multiply",
+    "scalar_divide", "elementwise_multiply", "modulo", "negate", "increment",
+    "decrement", "transpose", "determinant", "power", "compare", "sum",
+    "matrix_vector",
+};
+
+static const char* const BUCKET_LABELS[BUCKET_COUNT] = {
+    "<=1", "<=2", "<=4", "<=8", "<=16", "<=32", "<=64", "<=128", "<=256",
+    "<=512", "<=1024", "<=2048", "<=4096", "<=8192", "<=16384", ">16384",
+};
+
+/// @brief Smallest b with n <= 2^b, clamped to the last bucket
+int sizeBucket(int n) {
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && (1 << bucket) < n) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+const char* bucketLabel(int bucket) {
+    if (bucket < 0 || bucket >= BUCKET_COUNT) {
+        return "?";
+    }
+    return BUCKET_LABELS[bucket];
+}
+
+const char* opName(Op op) {
+    int index = static_cast<int>(op);
+    if (index < 0 || index >= OP_COUNT) {
+        return "?";
+    }
+    return OP_NAMES[index];
+}
+
+OpCounters& OpCounters::operator+=(const OpCounters& other) {
+    calls += other.calls;
+    nanos += other.nanos;
+    flops += other.flops;
+    bytes += other.bytes;
+    allocations += other.allocations;
+    allocatedBytes += other.allocatedBytes;
+    return *this;
+}
+
+Snapshot::Snapshot() : counters() {}
+
+OpCounters& Snapshot::at(Op op, int bucket) {
+    return counters[static_cast<int>(op)][bucket];
+}
+
+const OpCounters& Snapshot::at(Op op, int bucket) const {
+    return counters[static_cast<int>(op)][bucket];
+}
+
+OpCounters Snapshot::total(Op op) const {
+    OpCounters result;
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        result += at(op, b);
+    }
+    return result;
+}
+
+/// @brief One line per non-empty (operation, bucket) pair
+std::string Snapshot::toText() const {
+    std::ostringstream os;
+    os << "op size calls ns flops bytes allocs alloc_bytes\n";
+    for (int o = 0; o < OP_COUNT; ++o) {
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            const OpCounters& c = counters[o][b];
+            if (c.calls == 0 && c.allocations == 0) {
+                continue;
+            }
+            os << OP_NAMES[o] << ' ' << BUCKET_LABELS[b] << ' ' << c.calls << ' ' << c.nanos << ' '
+               << c.flops << ' ' << c.bytes << ' ' << c.allocations << ' ' << c.allocatedBytes << '\n';
+        }
+    }
+    return os.str();
+}
+
+/// @brief {"ops":[{"op":..,"size":..,"calls":..,...}, ...]} with non-empty entries only
+std::string Snapshot::toJson() const {
+    std::ostringstream os;
+    os << "{\"ops\":[";
+    bool first = true;
+    for (int o = 0; o < OP_COUNT; ++o) {
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            const OpCounters& c = counters[o][b];
+            if (c.calls == 0 && c.allocations == 0) {
+                continue;
+            }
+            if (!first) {
+                os << ',';
+            }
+            first = false;
+            os << "{\"op\":\"" << OP_NAMES[o] << "\",\"size\":\"" << BUCKET_LABELS[b]
+               << "\",\"calls\":" << c.calls << ",\"ns\":" << c.nanos
+               << ",\"flops\":" << c.flops << ",\"bytes\":" << c.bytes
+               << ",\"allocs\":" << c.allocations << ",\"alloc_bytes\":" << c.allocatedBytes << '}';
+        }
+    }
+    os << "]}";
+    return os.str();
+}
+
+Snapshot snapshot() {
+    Snapshot result;
+    for (int o = 0; o < OP_COUNT; ++o) {
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            const AtomicCounters& src = globalCounters[o][b];
+            OpCounters& dst = result.at(static_cast<Op>(o), b);
+            dst.calls = src.calls.load(std::memory_order_relaxed);
+            dst.nanos = src.nanos.load(std::memory_order_relaxed);
+            dst.flops = src.flops.load(std::memory_order_relaxed);
+            dst.bytes = src.bytes.load(std::memory_order_relaxed);
+            dst.allocations = src.allocations.load(std::memory_order_relaxed);
+            dst.allocatedBytes = src.allocatedBytes.load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void reset() {
+    for (int o = 0; o < OP_COUNT; ++o) {
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            AtomicCounters& c = globalCounters[o][b];
+            c.calls.store(0, std::memory_order_relaxed);
+            c.nanos.store(0, std::memory_order_relaxed);
+            c.flops.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+            c.allocations.store(0, std::memory_order_relaxed);
+            c.allocatedBytes.store(0, std::memory_order_relaxed);
+        }
+    }
+    // a call finishing concurrently on another thread may survive the reset
+    for (const std::shared_ptr<ThreadLatency>& thread : latencyThreads()) {
+        for (int o = 0; o < OP_COUNT; ++o) {
+            for (int b = 0; b < BUCKET_COUNT; ++b) {
+                std::atomic<std::uint64_t>* counts = thread->slots[o][b].load(std::memory_order_acquire);
+                if (counts == nullptr) {
+                    continue;
+                }
+                for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+                    counts[i].store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+void recordOp(Op op, int n, std::uint64_t nanos, std::uint64_t flops, std::uint64_t bytes) {
+    AtomicCounters& c = globalCounters[static_cast<int>(op)][sizeBucket(n)];
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.nanos.fetch_add(nanos, std::memory_order_relaxed);
+    c.flops.fetch_add(flops, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void recordLatency(Op op, int n, std::uint64_t nanos) {
+    ThreadLatency& local = localLatency();
+    std::atomic<std::atomic<std::uint64_t>*>& slot = local.slots[static_cast<int>(op)][sizeBucket(n)];
+    std::atomic<std::uint64_t>* counts = slot.load(std::memory_order_relaxed);
+    if (counts == nullptr) {
+        local.owned.emplace_back(new std::atomic<std::uint64_t>[LatencyHistogram::BUCKETS]);
+        counts = local.owned.back().get();
+        for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+        slot.store(counts, std::memory_order_release);
+    }
+    std::atomic<std::uint64_t>& count = counts[LatencyHistogram::bucketIndex(nanos)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+LatencyHistogram latency(Op op, int bucket) {
+    LatencyHistogram result;
+    mergeLatency(result, latencyThreads(), static_cast<int>(op), bucket);
+    return result;
+}
+
+LatencyHistogram latency(Op op) {
+    LatencyHistogram result;
+    std::vector<std::shared_ptr<ThreadLatency>> threads = latencyThreads();
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        mergeLatency(result, threads, static_cast<int>(op), b);
+    }
+    return result;
+}
+
+std::string latencyText() {
+    std::ostringstream os;
+    os << "op size count p50_ns p99_ns p999_ns max_ns\n";
+    std::vector<std::shared_ptr<ThreadLatency>> threads = latencyThreads();
+    for (int o = 0; o < OP_COUNT; ++o) {
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            LatencyHistogram h;
+            mergeLatency(h, threads, o, b);
+            if (h.count() == 0) {
+                continue;
+            }
+            os << OP_NAMES[o] << ' ' << BUCKET_LABELS[b] << ' ' << h.count() << ' ' << h.percentile(50.0) << ' '
+               << h.percentile(99.0) << ' ' << h.percentile(99.9) << ' ' << h.max() << '\n';
+        }
+    }
+    return os.str();
+}
+
+void recordAllocation(std::size_t bytes) {
+    Op op = scopeDepth > 0 ? currentOp : Op::Construct;
+    int n = scopeDepth > 0 ? currentSize : 0;
+    AtomicCounters& c = globalCounters[static_cast<int>(op)][sizeBucket(n)];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+OpScope::OpScope(Op op, int n, std::uint64_t flops, std::uint64_t bytes)
+    : op(op), n(n), flops(flops), bytes(bytes), algorithm(nullptr), parent(innermost),
+      startNs(trace::now()) {
+    if (scopeDepth == 0) {
+        currentOp = op;
+        currentSize = n;
+    }
+    ++scopeDepth;
+    innermost = this;
+}
+
+OpScope::~OpScope() {
+    [[maybe_unused]] std::uint64_t elapsed = trace::now() - startNs;
+    innermost = parent;
+    --scopeDepth;
+#if SQUAREMAT_STATS
+    if (scopeDepth == 0) {
+        recordOp(op, n, elapsed, flops, bytes);
+        recordLatency(op, n, elapsed);
+    }
+#endif
+#if SQUAREMAT_TRACE
+    if (trace::enabled()) {
+        trace::record(trace::Event{opName(op), algorithm, n, startNs, elapsed});
+    }
+#endif
+}
+
+void OpScope::setAlgorithm(const char* name) {
+    if (innermost != nullptr) {
+        innermost->algorithm = name;
+    }
+}
+
+} // namespace stats
+} // namespace matrix
@@ -0,0 +1,145 @@
+//agassinoa20@gmail.com
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include "Histogram.hpp"
+#include "Trace.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Optional per-operator instrumentation. Build the library with
+// -DSQUAREMAT_STATS=1 to record calls, time, FLOPs, bytes touched and buffer
+// allocations for every public SquareMat operation (and/or with
+// -DSQUAREMAT_TRACE=1 for timeline events, see Trace.hpp). With both at the
+// default of 0 the SQUAREMAT_OP_* hooks expand to nothing and cost nothing.
+#ifndef SQUAREMAT_STATS
+#define SQUAREMAT_STATS 0
+#endif
+
+namespace matrix {
+namespace stats {
+
+/// @brief Public operations that are counted separately.
+enum class Op {
+    Construct,
+    Copy,
+    Add,
+    Subtract,
+    Multiply,
+    ScalarMultiply,
+    ScalarDivide,
+    ElementwiseMultiply,
+    Modulo,
+    Negate,
+    Increment,
+    Decrement,
+    Transpose,
+    Determinant,
+    Power,
+    Compare,
+    Sum,
+    MatrixVector,
+    Count  // number of operations, not an operation
+};
+
+/// @brief Matrix sizes are grouped by powers of two: bucket b holds 2^(b-1) < n <= 2^b.
+const int BUCKET_COUNT = 16;
+int sizeBucket(int n);
+const char* bucketLabel(int bucket);
+const char* opName(Op op);
+
+/// @brief Aggregated counters for one (operation, size bucket) pair.
+struct OpCounters {
+    std::uint64_t calls = 0;
+    std::uint64_t nanos = 0;
+    std::uint64_t flops = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t allocatedBytes = 0;
+
+    OpCounters& operator+=(const OpCounters& other);
+};
+
+/// @brief Point-in-time copy of every counter, safe to inspect while work continues.
+class Snapshot {
+private:
+    OpCounters counters[static_cast<int>(Op::Count)][BUCKET_COUNT];
+
+public:
+    Snapshot();
+
+    OpCounters& at(Op op, int bucket);
+    const OpCounters& at(Op op, int bucket) const;
+    OpCounters total(Op op) const;  // summed over size buckets
+
+    std::string toText() const;
+    std::string toJson() const;
+};
+
+Snapshot snapshot();
+void reset();
+
+/// @brief Adds one completed call to the global counters (used by OpScope).
+void recordOp(Op op, int n, std::uint64_t nanos, std::uint64_t flops, std::uint64_t bytes);
+
+/// @brief Latency distribution of one (operation, size bucket) pair, merged
+/// over every thread that has recorded it.
+LatencyHistogram latency(Op op, int bucket);
+
+/// @brief Latency distribution of one operation over all size buckets.
+LatencyHistogram latency(Op op);
+
+/// @brief One line per non-empty (operation, bucket) pair with count, p50,
+/// p99, p99.9 and max in nanoseconds.
+std::string latencyText();
+
+/// @brief Adds one call duration to the calling thread's histogram (used by OpScope).
+void recordLatency(Op op, int n, std::uint64_t nanos);
+
+/// @brief Attributes a buffer allocation to the innermost running operation
+/// (or to Construct when no operation is running on this thread).
+void recordAllocation(std::size_t bytes);
+
+/// @brief RAII timer around one public operation. Only the outermost scope on a
+/// thread feeds the counters and latency histograms, so `a + b` counts as one Add rather than an Add
+/// plus a Copy; the trace gets every scope, nested ones included.
+class OpScope {
+private:
+    Op op;
+    int n;
+    std::uint64_t flops;
+    std::uint64_t bytes;
+    const char* algorithm;
+    OpScope* parent;
+    std::uint64_t startNs;
+
+public:
+    OpScope(Op op, int n, std::uint64_t flops, std::uint64_t bytes);
+    ~OpScope();
+    OpScope(const OpScope&) = delete;
+    OpScope& operator=(const OpScope&) = delete;
+
+    /// @brief Labels the innermost running scope with the algorithm that was chosen.
+    static void setAlgorithm(const char* name);
+};
+
+} // namespace stats
+} // namespace matrix
+
+#if SQUAREMAT_STATS || SQUAREMAT_TRACE
+#define SQUAREMAT_OP_SCOPE(op, n, flops, bytes) \
+    ::matrix::stats::OpScope squarematOpScope(::matrix::stats::Op::op, (n), (flops), (bytes))
+#define SQUAREMAT_OP_ALGORITHM(name) ::matrix::stats::OpScope::setAlgorithm(name)
+#else
+#define SQUAREMAT_OP_SCOPE(op, n, flops, bytes) ((void)0)
+#define SQUAREMAT_OP_ALGORITHM(name) ((void)0)
+#endif
+
+#if SQUAREMAT_STATS
+#define SQUAREMAT_COUNT_ALLOCATION(bytes) ::matrix::stats::recordAllocation(bytes)
+#else
+#define SQUAREMAT_COUNT_ALLOCATION(bytes) ((void)0)
+#endif
+
+#endif // STATS_HPP
@@ -0,0 +1,205 @@
+//agassinoa20@gmail.com
+#include "TaskGraph.hpp"
+
+namespace matrix {
+
+TaskGraph::TaskGraph(ThreadPool& pool) : pool(pool), remaining(0) {}
+
+const TaskGraph::NodeData& TaskGraph::at(Node node) const {
+    if (node < 0 || node >= static_cast<int>(nodes.size())) {
+        throw MatrixException("Unknown task graph node");
+    }
+    return *nodes[node];
+}
+
+TaskGraph::Node TaskGraph::addNode(std::vector<Node> inputs, int size, Kernel kernel) {
+    Node id = static_cast<Node>(nodes.size());
+    for (Node input : inputs) {
+        at(input);  // validates the handle
+    }
+    std::unique_ptr<NodeData> data = std::make_unique<NodeData>();
+    data->inputs = std::move(inputs);
+    data->kernel = std::move(kernel);
+    data->size = size;
+    data->output = false;
+    for (Node input : data->inputs) {
+        nodes[input]->consumers.push_back(id);
+    }
+    nodes.push_back(std::move(data));
+    return id;
+}
+
+TaskGraph::Node TaskGraph::input(const SquareMat& mat) {
+    Node id = addNode({}, mat.getSize(), Kernel());
+    nodes[id]->value = std::make_unique<SquareMat>(mat);
+    return id;
+}
+
+TaskGraph::Node TaskGraph::multiply(Node a, Node b) {
+    if (at(a).size != at(b).size) {
+        throw MatrixException("Matrices must have the same dimensions for multiplication");
+    }
+    return addNode({a, b}, at(a).size, [](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::multiply(dst, *in[0], *in[1]);
+    });
+}
+
+TaskGraph::Node TaskGraph::add(Node a, Node b) {
+    if (at(a).size != at(b).size) {
+        throw MatrixException("Matrices must have the same dimensions for +=");
+    }
+    return addNode({a, b}, at(a).size, [](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::add(dst, *in[0], *in[1]);
+    });
+}
+
+TaskGraph::Node TaskGraph::subtract(Node a, Node b) {
+    if (at(a).size != at(b).size) {
+        throw MatrixException("Matrices must have the same dimensions for -=");
+    }
+    return addNode({a, b}, at(a).size, [](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::subtract(dst, *in[0], *in[1]);
+    });
+}
+
+TaskGraph::Node TaskGraph::transpose(Node a) {
+    return addNode({a}, at(a).size, [](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::transpose(dst, *in[0]);
+    });
+}
+
+TaskGraph::Node TaskGraph::scale(Node a, double scalar) {
+    return addNode({a}, at(a).size, [scalar](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::multiply(dst, *in[0], scalar);
+    });
+}
+
+TaskGraph::Node TaskGraph::power(Node a, int k) {
+    if (k < 0) {
+        throw MatrixException("Negative powers not supported");
+    }
+    return addNode({a}, at(a).size, [k](SquareMat& dst, const std::vector<const SquareMat*>& in) {
+        matrix::power(dst, *in[0], k);
+    });
+}
+
+TaskGraph::Node TaskGraph::custom(std::vector<Node> inputs, int size, Kernel kernel) {
+    if (size <= 0) {
+        throw MatrixException("matrix size must be positive");
+    }
+    return addNode(std::move(inputs), size, std::move(kernel));
+}
+
+void TaskGraph::output(Node node) {
+    at(node);
+    nodes[node]->output = true;
+}
+
+/// @brief A recycled intermediate of this size if there is one, else a new matrix
+std::unique_ptr<SquareMat> TaskGraph::takeBuffer(int size) {
+    {
+        std::lock_guard<std::mutex> lock(recycleMutex);
+        for (std::size_t i = 0; i < recycled.size(); ++i) {
+            if (recycled[i]->getSize() == size) {
+                std::unique_ptr<SquareMat> buffer = std::move(recycled[i]);
+                recycled[i] = std::move(recycled.back());
+                recycled.pop_back();
+                return buffer;
+            }
+        }
+    }
+    return std::make_unique<SquareMat>(size);
+}
+
+void TaskGraph::execute(Node node) {
+    NodeData& data = *nodes[node];
+    bool failed;
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        failed = static_cast<bool>(failure);
+    }
+    if (!failed) {
+        try {
+            std::vector<const SquareMat*> inputs;
+            inputs.reserve(data.inputs.size());
+            for (Node input : data.inputs) {
+                inputs.push_back(nodes[input]->value.get());
+            }
+            std::unique_ptr<SquareMat> dst = takeBuffer(data.size);
+            data.kernel(*dst, inputs);
+            data.value = std::move(dst);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    finish(node);
+}
+
+/// @brief Releases inputs whose last consumer this was, starts consumers that
+/// became ready and signals run() when the last node is done
+void TaskGraph::finish(Node node) {
+    NodeData& data = *nodes[node];
+    for (Node input : data.inputs) {
+        NodeData& source = *nodes[input];
+        if (source.pendingConsumers.fetch_sub(1, std::memory_order_acq_rel) == 1 && !source.output &&
+            source.kernel && source.value) {
+            std::lock_guard<std::mutex> lock(recycleMutex);
+            recycled.push_back(std::move(source.value));
+        }
+    }
+    for (Node consumer : data.consumers) {
+        if (nodes[consumer]->pendingInputs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pool.post([this, consumer] { execute(consumer); });
+        }
+    }
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (--remaining == 0) {
+        doneSignal.notify_all();
+    }
+}
+
+void TaskGraph::run() {
+    failure = nullptr;
+    remaining = static_cast<int>(nodes.size());
+    std::vector<Node> ready;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        NodeData& data = *nodes[i];
+        data.pendingInputs.store(static_cast<int>(data.inputs.size()), std::memory_order_relaxed);
+        data.pendingConsumers.store(static_cast<int>(data.consumers.size()), std::memory_order_relaxed);
+        if (data.kernel) {
+            data.value.reset();  // recomputed on every run
+        }
+        if (data.inputs.empty()) {
+            ready.push_back(static_cast<Node>(i));
+        }
+    }
+    if (remaining == 0) {
+        return;
+    }
+    for (Node node : ready) {
+        if (nodes[node]->kernel) {
+            pool.post([this, node] { execute(node); });
+        } else {
+            finish(node);  // inputs already hold their value
+        }
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneSignal.wait(lock, [this] { return remaining == 0; });
+    recycled.clear();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+const SquareMat& TaskGraph::result(Node node) const {
+    const NodeData& data = at(node);
+    if (!data.value) {
+        throw MatrixException("Task graph node has no value; mark it with output() before run()");
+    }
+    return *data.value;
+}
+
+} // namespace matrix
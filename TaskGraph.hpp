@@ -0,0 +1,86 @@
+//agassinoa20@gmail.com
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include "SquareMat.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace matrix {
+
+/// @brief Deferred matrix expression DAG, e.g. d = a*b + a*c; e = ~d * d.
+/// Nodes are declared first (sizes are checked at declaration), then run()
+/// executes every node whose inputs are ready in parallel on a pool. When the
+/// last consumer of an intermediate finishes, its buffer goes back to the
+/// graph and becomes the destination of a later node of the same size, so a
+/// long chain of same-sized products allocates only a few buffers.
+/// Only nodes marked with output() (and inputs) can be read after run().
+class TaskGraph {
+public:
+    using Node = int;
+    /// @brief Custom node body: writes the result into dst (already sized).
+    using Kernel = std::function<void(SquareMat& dst, const std::vector<const SquareMat*>& inputs)>;
+
+private:
+    struct NodeData {
+        std::vector<Node> inputs;
+        std::vector<Node> consumers;
+        Kernel kernel;  // empty for inputs
+        int size;
+        bool output;
+        std::unique_ptr<SquareMat> value;
+        std::atomic<int> pendingInputs{0};
+        std::atomic<int> pendingConsumers{0};
+    };
+
+    ThreadPool& pool;
+    std::vector<std::unique_ptr<NodeData>> nodes;
+
+    // run() state
+    std::mutex recycleMutex;
+    std::vector<std::unique_ptr<SquareMat>> recycled;
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+    int remaining;
+    std::exception_ptr failure;
+
+    Node addNode(std::vector<Node> inputs, int size, Kernel kernel);
+    const NodeData& at(Node node) const;
+    std::unique_ptr<SquareMat> takeBuffer(int size);
+    void execute(Node node);
+    void finish(Node node);
+
+public:
+    explicit TaskGraph(ThreadPool& pool = ThreadPool::shared());
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    Node input(const SquareMat& mat);  // O(1) copy-on-write copy
+    Node multiply(Node a, Node b);
+    Node add(Node a, Node b);
+    Node subtract(Node a, Node b);
+    Node transpose(Node a);
+    Node scale(Node a, double scalar);
+    Node power(Node a, int k);
+    Node custom(std::vector<Node> inputs, int size, Kernel kernel);
+
+    /// @brief Keeps the node's value after run() so result() can read it.
+    void output(Node node);
+
+    /// @brief Evaluates the graph and blocks until every node is done. The first
+    /// exception thrown by a node is rethrown here (nodes depending on it are
+    /// skipped). Must not be called from a task running on the same pool.
+    void run();
+
+    const SquareMat& result(Node node) const;
+};
+
+} // namespace matrix
+
+#endif // TASK_GRAPH_HPP
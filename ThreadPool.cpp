@@ -0,0 +1,267 @@
+//agassinoa20@gmail.com
+#include "ThreadPool.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace matrix {
+
+// Which pool (and which of its workers) the calling thread belongs to.
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(int threads, bool pinWorkers)
+    : concurrency(0), queued(0), nextQueue(0), stopping(false) {
+    start(threads, pinWorkers);
+}
+
+ThreadPool::ThreadPool(Executor executor, int concurrency)
+    : executor(std::move(executor)), concurrency(concurrency < 1 ? 1 : concurrency), queued(0),
+      nextQueue(0), stopping(false) {}
+
+void ThreadPool::start(int threads, bool pinWorkers) {
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) {
+        threads = hardware;
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+    concurrency = threads;
+    queues.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Worker>());
+    }
+    workers.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+#ifdef __linux__
+        // best effort: a restricted cpuset just leaves the worker unpinned
+        if (pinWorkers && hardware > 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % hardware, &cpus);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus);
+        }
+#else
+        (void)pinWorkers;
+#endif
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return concurrency;
+}
+
+void ThreadPool::push(int queue, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        // pairs with the predicate check in workerLoop so the wakeup is not lost
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    if (executor) {
+        executor(std::move(task));
+        return;
+    }
+    int queue = currentPool == this ? currentWorker  // forked: the owner pops it LIFO
+                                    : static_cast<int>(nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+    push(queue, std::move(task));
+}
+
+/// @brief Own deque from the back, then the others' from the front
+bool ThreadPool::takeTask(int self, std::function<void()>& task) {
+    if (queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    int count = static_cast<int>(queues.size());
+    for (int offset = 0; offset < count; ++offset) {
+        Worker& worker = *queues[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        } else {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runPending() {
+    if (currentPool != this) {
+        return false;
+    }
+    std::function<void()> task;
+    if (!takeTask(currentWorker, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int index) {
+    currentPool = this;
+    currentWorker = index;
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) {
+            return;  // stopping and drained
+        }
+    }
+}
+
+static std::mutex sharedMutex;
+static std::unique_ptr<ThreadPool> sharedPool;
+static std::atomic<ThreadPool*> sharedInstance{nullptr};
+static int sharedThreads = 0;
+static bool sharedPin = false;
+static ThreadPool::Executor sharedExecutor;
+static int sharedConcurrency = 1;
+
+ThreadPool& ThreadPool::shared() {
+    ThreadPool* pool = sharedInstance.load(std::memory_order_acquire);
+    if (pool) {
+        return *pool;
+    }
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (!sharedPool) {
+        if (sharedExecutor) {
+            sharedPool = std::make_unique<ThreadPool>(sharedExecutor, sharedConcurrency);
+        } else {
+            sharedPool = std::make_unique<ThreadPool>(sharedThreads, sharedPin);
+        }
+        sharedInstance.store(sharedPool.get(), std::memory_order_release);
+    }
+    return *sharedPool;
+}
+
+bool ThreadPool::configureShared(int threads, bool pinWorkers) {
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (sharedPool) {
+        return false;
+    }
+    sharedThreads = threads;
+    sharedPin = pinWorkers;
+    sharedExecutor = nullptr;
+    return true;
+}
+
+bool ThreadPool::useSharedExecutor(Executor executor, int concurrency) {
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (sharedPool) {
+        return false;
+    }
+    sharedExecutor = std::move(executor);
+    sharedConcurrency = concurrency;
+    return true;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool), state(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::execute(Slot& slot, State& state) {
+    std::exception_ptr failure;
+    try {
+        slot.body();
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    slot.body = nullptr;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (failure && !state.failure) {
+        state.failure = failure;
+    }
+    if (--state.pending == 0) {
+        state.done.notify_all();
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    std::shared_ptr<Slot> slot = std::make_shared<Slot>();
+    slot->body = std::move(task);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        ++state->pending;
+    }
+    slots.push_back(slot);
+    // the queued copy is a no-op if wait() has already claimed the slot
+    std::shared_ptr<State> shared = state;
+    pool.post([slot, shared] {
+        if (!slot->claimed.exchange(true, std::memory_order_acq_rel)) {
+            execute(*slot, *shared);
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    // newest first, like the owner end of a worker deque
+    for (auto it = slots.rbegin(); it != slots.rend(); ++it) {
+        if (!(*it)->claimed.exchange(true, std::memory_order_acq_rel)) {
+            execute(**it, *state);
+        }
+    }
+    slots.clear();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->pending == 0) {
+                break;
+            }
+        }
+        if (!pool.runPending()) {
+            // the remaining tasks are running on other threads
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->done.wait(lock, [this] { return state->pending == 0; });
+            break;
+        }
+    }
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        failure = state->failure;
+        state->failure = nullptr;
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace matrix
@@ -0,0 +1,134 @@
+//agassinoa20@gmail.com
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace matrix {
+
+/// @brief Work-stealing worker pool, the library's single execution engine:
+/// the async API, task graphs and the parallel kernels all run on it.
+/// Every worker owns a deque: tasks forked from a worker go to the back of its
+/// own deque and are popped LIFO (cache-warm, depth-first), idle workers steal
+/// from the front of the others' deques. Tasks posted from outside the pool are
+/// spread round-robin. Alternatively the pool can forward every task to an
+/// external executor the application already owns.
+/// The destructor runs every task already queued, then joins the workers.
+class ThreadPool {
+public:
+    /// @brief External executor: must eventually run every task it is given.
+    using Executor = std::function<void(std::function<void()>)>;
+
+private:
+    struct Worker {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Worker>> queues;
+    std::vector<std::thread> workers;
+    Executor executor;
+    int concurrency;
+    std::atomic<long> queued;
+    std::atomic<unsigned> nextQueue;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void start(int threads, bool pinWorkers);
+    void push(int queue, std::function<void()> task);
+    bool takeTask(int self, std::function<void()>& task);
+    void workerLoop(int index);
+
+public:
+    explicit ThreadPool(int threads = 0, bool pinWorkers = false);  // 0 means one per hardware thread
+    /// @brief Pool without threads of its own; `concurrency` is what size() reports.
+    ThreadPool(Executor executor, int concurrency);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const;
+
+    /// @brief Queues a fire-and-forget task; it must not throw.
+    void post(std::function<void()> task);
+
+    /// @brief Queues f and returns a future for its result (or exception).
+    template <class F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& f);
+
+    /// @brief Runs one queued task on the calling worker thread of this pool,
+    /// stealing if its own deque is empty. False if nothing ran (or the caller
+    /// is not one of this pool's workers).
+    bool runPending();
+
+    /// @brief Library-wide pool, created on first use.
+    static ThreadPool& shared();
+
+    /// @brief Worker count and CPU pinning (worker i on CPU i) of shared().
+    /// Only effective before the first use of shared(); returns false after.
+    static bool configureShared(int threads, bool pinWorkers = false);
+
+    /// @brief Makes shared() forward to an external executor. Only effective
+    /// before the first use of shared(); returns false after.
+    static bool useSharedExecutor(Executor executor, int concurrency);
+};
+
+template <class F>
+std::future<std::invoke_result_t<std::decay_t<F>>> ThreadPool::submit(F&& f) {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    // packaged_task is move-only and std::function needs a copyable target
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+    std::future<Result> result = task->get_future();
+    post([task] { (*task)(); });
+    return result;
+}
+
+/// @brief Fork/join scope for recursive algorithms: run() forks a task onto the
+/// pool, wait() joins them all. A task nobody has started yet when wait() is
+/// reached is run by the waiting thread itself, and a waiting worker keeps
+/// executing other queued tasks, so nested groups never deadlock even on a
+/// one-thread pool or a busy external executor. The first exception thrown by
+/// a task is rethrown from wait().
+class TaskGroup {
+private:
+    struct Slot {
+        std::atomic<bool> claimed{false};
+        std::function<void()> body;
+    };
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        int pending = 0;
+        std::exception_ptr failure;
+    };
+
+    ThreadPool& pool;
+    std::shared_ptr<State> state;
+    std::vector<std::shared_ptr<Slot>> slots;
+
+    static void execute(Slot& slot, State& state);
+
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared());
+    ~TaskGroup();  // waits, discarding any exception
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+};
+
+} // namespace matrix
+
+#endif // THREAD_POOL_HPP
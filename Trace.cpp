@@ -0,0 +1,130 @@
+//agassinoa20@gmail.com
+#include "Trace.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace matrix {
+namespace trace {
+
+/// @brief Single-producer ring: only the owning thread advances head, only
+/// flush() (serialized by flushMutex) advances tail.
+struct Ring {
+    Event events[RING_CAPACITY];
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> tail{0};
+    int tid = 0;
+};
+
+static std::atomic<bool> tracing{false};
+static std::atomic<std::uint64_t> dropped{0};
+static std::mutex registryMutex;
+static std::mutex flushMutex;
+static std::vector<std::shared_ptr<Ring>> registry;
+
+static std::chrono::steady_clock::time_point epoch() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+/// @brief The calling thread's ring, registered on first use and kept alive by
+/// the registry so events survive the thread.
+static Ring& localRing() {
+    static thread_local std::shared_ptr<Ring> ring;
+    if (!ring) {
+        ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ring->tid = static_cast<int>(registry.size()) + 1;
+        registry.push_back(ring);
+    }
+    return *ring;
+}
+
+void start() {
+    epoch();
+    tracing.store(true, std::memory_order_release);
+}
+
+void stop() {
+    tracing.store(false, std::memory_order_release);
+}
+
+bool enabled() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+std::uint64_t now() {
+    auto elapsed = std::chrono::steady_clock::now() - epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void record(const Event& event) {
+    Ring& ring = localRing();
+    std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    std::uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= RING_CAPACITY) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head % RING_CAPACITY] = event;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+/// @brief Chrome timestamps are microseconds; keep the nanosecond fraction
+static void writeMicros(std::ostream& os, std::uint64_t ns) {
+    os << ns / 1000 << '.';
+    std::uint64_t frac = ns % 1000;
+    os << static_cast<char>('0' + frac / 100) << static_cast<char>('0' + frac / 10 % 10)
+       << static_cast<char>('0' + frac % 10);
+}
+
+void flush(std::ostream& os) {
+    std::lock_guard<std::mutex> flushLock(flushMutex);
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings = registry;
+    }
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const std::shared_ptr<Ring>& ring : rings) {
+        if (!first) {
+            os << ',';
+        }
+        first = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+           << ",\"args\":{\"name\":\"thread " << ring->tid << "\"}}";
+        std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        for (std::uint64_t i = tail; i < head; ++i) {
+            const Event& e = ring->events[i % RING_CAPACITY];
+            os << ",{\"name\":\"" << e.name << "\",\"cat\":\"squaremat\",\"ph\":\"X\",\"ts\":";
+            writeMicros(os, e.startNs);
+            os << ",\"dur\":";
+            writeMicros(os, e.durationNs);
+            os << ",\"pid\":1,\"tid\":" << ring->tid << ",\"args\":{\"n\":" << e.n
+               << ",\"algorithm\":\"" << (e.algorithm ? e.algorithm : "") << "\"}}";
+        }
+        ring->tail.store(head, std::memory_order_release);
+    }
+    os << "]}\n";
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    flush(out);
+    return static_cast<bool>(out);
+}
+
+std::uint64_t droppedEvents() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace trace
+} // namespace matrix
@@ -0,0 +1,57 @@
+//agassinoa20@gmail.com
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Timeline tracing in the Chrome Trace Event format (chrome://tracing, Perfetto).
+// Build the library with -DSQUAREMAT_TRACE=1 and call trace::start(): every
+// public operation then emits one complete event carrying the matrix size, the
+// algorithm that ran and the calling thread. Events go into a fixed-size ring
+// owned by the emitting thread (single producer, no locks on the hot path) and
+// are drained by flush()/writeChromeTrace().
+#ifndef SQUAREMAT_TRACE
+#define SQUAREMAT_TRACE 0
+#endif
+
+namespace matrix {
+namespace trace {
+
+/// @brief One completed operation. Name and algorithm must be string literals.
+struct Event {
+    const char* name;
+    const char* algorithm;
+    int n;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+};
+
+/// @brief Events each thread can buffer between flushes; later events are dropped.
+const std::size_t RING_CAPACITY = 1 << 14;
+
+void start();
+void stop();
+bool enabled();
+
+/// @brief Nanoseconds since the trace epoch (first use of the tracing clock).
+std::uint64_t now();
+
+/// @brief Appends an event to the calling thread's ring (used by OpScope).
+void record(const Event& event);
+
+/// @brief Drains every thread's ring as a Chrome trace JSON document.
+void flush(std::ostream& os);
+
+/// @brief flush() into a file; returns false if the file cannot be written.
+bool writeChromeTrace(const std::string& path);
+
+/// @brief Total events discarded because their thread's ring was full.
+std::uint64_t droppedEvents();
+
+} // namespace trace
+} // namespace matrix
+
+#endif // TRACE_HPP
@@ -0,0 +1,174 @@
+//agassinoa20@gmail.com
+#include "SquareMat.hpp"
+#include "ModMat.hpp"
+#include "PerfCounters.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+using namespace matrix;
+
+// Micro-benchmarks for the main kernels. Usage:
+//   ./bench [--perf] [--min-ms N] [size ...]
+// --perf reads hardware counters around each kernel (see PerfCounters.hpp) and
+// adds per-element and per-FLOP rates; columns print n/a when a counter is not
+// available, and the benchmark still runs without any. The counters are opened
+// before any kernel starts the thread pool, so they include its workers.
+
+static volatile double sink = 0.0;
+
+struct Kernel {
+    const char* name;
+    double flops;     // per call
+    double elements;  // matrix elements touched per call
+    function<void()> run;
+};
+
+static void printRate(double value, bool valid) {
+    if (valid) {
+        cout << setw(11) << fixed << setprecision(3) << value;
+    } else {
+        cout << setw(11) << "n/a";
+    }
+}
+
+static void runKernel(const Kernel& kernel, int n, double minMs, perf::PerfCounters* counters) {
+    kernel.run();  // warm up caches and page in buffers
+
+    // grow the repetition count until one timed batch lasts at least minMs
+    long reps = 1;
+    double elapsedNs = 0.0;
+    perf::Reading reading;
+    while (true) {
+        if (counters != nullptr) {
+            counters->start();
+        }
+        auto begin = chrono::steady_clock::now();
+        for (long r = 0; r < reps; ++r) {
+            kernel.run();
+        }
+        auto end = chrono::steady_clock::now();
+        if (counters != nullptr) {
+            reading = counters->stop();
+        }
+        elapsedNs = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(end - begin).count());
+        if (elapsedNs >= minMs * 1e6 || reps >= (1L << 30)) {
+            break;
+        }
+        reps *= 2;
+    }
+
+    double perCall = elapsedNs / static_cast<double>(reps);
+    cout << left << setw(10) << kernel.name << right << setw(6) << n << setw(11) << reps;
+    cout << setw(14) << fixed << setprecision(1) << perCall;
+    printRate(kernel.flops > 0 ? kernel.flops / perCall : 0.0, kernel.flops > 0);
+    if (counters != nullptr) {
+        double calls = static_cast<double>(reps);
+        double cycles = static_cast<double>(reading.get(perf::Counter::Cycles)) / calls;
+        double instructions = static_cast<double>(reading.get(perf::Counter::Instructions)) / calls;
+        bool hasCycles = reading.has(perf::Counter::Cycles);
+        printRate(cycles > 0 ? instructions / cycles : 0.0, hasCycles && reading.has(perf::Counter::Instructions));
+        printRate(cycles / kernel.elements, hasCycles);
+        printRate(kernel.flops > 0 ? cycles / kernel.flops : 0.0, hasCycles && kernel.flops > 0);
+        perf::Counter misses[] = {perf::Counter::L1DMisses, perf::Counter::LLCMisses, perf::Counter::DTLBMisses};
+        for (perf::Counter counter : misses) {
+            printRate(static_cast<double>(reading.get(counter)) / calls / kernel.elements, reading.has(counter));
+        }
+    }
+    cout << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    bool usePerf = false;
+    double minMs = 200.0;
+    vector<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            usePerf = true;
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = atof(argv[++i]);
+        } else if (atoi(argv[i]) > 0) {
+            sizes.push_back(atoi(argv[i]));
+        } else {
+            cerr << "usage: " << argv[0] << " [--perf] [--min-ms N] [size ...]\n";
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {64, 128, 256, 512};
+    }
+
+    perf::PerfCounters counters;  // before the pool starts, so its workers inherit the counters
+    perf::PerfCounters* active = nullptr;
+    if (usePerf) {
+        if (counters.available()) {
+            active = &counters;
+            for (int c = 0; c < perf::COUNTER_COUNT; ++c) {
+                if (!counters.available(static_cast<perf::Counter>(c))) {
+                    cerr << "perf: " << perf::counterName(static_cast<perf::Counter>(c)) << " unavailable\n";
+                }
+            }
+        } else {
+            cerr << "perf: hardware counters unavailable, reporting wall time only\n";
+        }
+    }
+    if (active != nullptr) {
+        cerr << "perf: counters cover the calling thread and all pool workers\n";
+    }
+
+    cout << left << setw(10) << "op" << right << setw(6) << "n" << setw(11) << "reps" << setw(14) << "ns/call"
+         << setw(11) << "GFLOP/s";
+    if (active != nullptr) {
+        cout << setw(11) << "IPC" << setw(11) << "cyc/elem" << setw(11) << "cyc/flop" << setw(11) << "l1d/elem"
+             << setw(11) << "llc/elem" << setw(11) << "dtlb/elem";
+    }
+    cout << '\n';
+
+    for (int n : sizes) {
+        SquareMat a(n);
+        SquareMat b(n);
+        for (int i = 0; i < n; ++i) {
+            for (double& value : a.row(i)) {
+                value = rand() % 100 / 10.0;
+            }
+            for (double& value : b.row(i)) {
+                value = rand() % 100 / 10.0;
+            }
+        }
+        ModMat counts(n, 1000000007);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                counts.set(i, j, rand() % 1000);
+            }
+        }
+        SquareMat product(n);
+        double cells = static_cast<double>(n) * n;
+        Kernel kernels[] = {
+            // a * b reads two matrices and writes one
+            {"multiply", 2.0 * cells * n, 3.0 * cells, [&] { SquareMat c = a * b; sink = sink + c[0][0]; }},
+            // product shares a, so *= detaches once and then multiplies in place
+            {"multiply=", 2.0 * cells * n, 3.0 * cells, [&] {
+                 product = a;
+                 product *= b;
+                 sink = sink + product[0][0];
+             }},
+            {"transpose", 0.0, 2.0 * cells, [&] { SquareMat t(~a); sink = sink + t[0][0]; }},
+            {"sum", cells, cells, [&] { sink = sink + a.sum(); }},
+            {"modulo", 0.0, 2.0 * cells, [&] { SquareMat r = a % 7; sink = sink + r[0][0]; }},
+            // (M ^ 10^18) mod p: about 90 modular products, integer work so no GFLOP/s
+            {"modpow", 0.0, 90.0 * 3.0 * cells, [&] {
+                 ModMat p = counts ^ 1000000000000000000ULL;
+                 sink = sink + static_cast<double>(p.at(0, 0));
+             }},
+        };
+        for (const Kernel& kernel : kernels) {
+            runKernel(kernel, n, minMs, active);
+        }
+    }
+    return 0;
+}
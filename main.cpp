@@ -76,8 +76,10 @@ int main() {
 
     // ---------- Random matrix ----------
     SquareMat randMat(SIZE);
-    for (int i = 0; i < SIZE * SIZE; ++i) {
-        randMat[i / SIZE][i % SIZE] = (rand() % 100) / 10.0; // Range: 0.0 to 9.9
+    for (int i = 0; i < SIZE; ++i) {
+        for (double& value : randMat.row(i)) {
+            value = (rand() % 100) / 10.0; // Range: 0.0 to 9.9
+        }
     }
     cout << "\nRandom matrix (" << SIZE << "x" << SIZE << "):\n" << randMat;
 
@@ -2,7 +2,24 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "SquareMat.hpp"
+#include "Async.hpp"
+#include "LowRankMat.hpp"
+#include "MatrixView.hpp"
+#include "Memory.hpp"
+#include "ModMat.hpp"
+#include "PowerLadder.hpp"
+#include "Stats.hpp"
+#include "TaskGraph.hpp"
+#include "Trace.hpp"
+#include <algorithm>
 #include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace matrix;
 
@@ -63,6 +80,35 @@ TEST_SUITE("Basic Operations") {
         CHECK_THROWS_AS(m % 0, MatrixException);
     }
 
+    TEST_CASE("Modulo matches std::fmod bit for bit") {
+        const double big = 4503599627370496.0;  // 2^52, where the exact fast path ends
+        std::vector<double> values = {0.0, -0.0, 7.0, -7.0, 6.0, -6.0, 2.5, -2.5, 1e-300, -5e-324,
+                                      2.9999999999999996, 3.0000000000000004, 123456789.123, -987654.321,
+                                      big - 1.0, big - 0.5, big, -big, 1e17, -3e300,
+                                      std::numeric_limits<double>::infinity(),
+                                      std::numeric_limits<double>::quiet_NaN()};
+        std::uint64_t state = 42;
+        while (values.size() < 100) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            double unit = static_cast<double>(state >> 11) / 9007199254740992.0;
+            values.push_back((unit - 0.5) * std::pow(10.0, static_cast<double>(state % 17)));
+        }
+        SquareMat source(10, values.data());
+        for (int mod : {3, -3, 1, 7, 1000000007, std::numeric_limits<int>::min()}) {
+            SquareMat result = source % mod;
+            for (int i = 0; i < 100; ++i) {
+                double expected = std::fmod(values[i], static_cast<double>(mod));
+                double actual = result[i / 10][i % 10];
+                if (std::isnan(expected)) {
+                    CHECK(std::isnan(actual));
+                } else {
+                    CHECK(actual == expected);
+                    CHECK(std::signbit(actual) == std::signbit(expected));
+                }
+            }
+        }
+    }
+
     TEST_CASE("Determinant") {
         double d[] = {1, 2, 3, 4};
         SquareMat m(2, d);
@@ -74,9 +120,97 @@ TEST_SUITE("Basic Operations") {
         m[0][0] = m[0][1] = 0;
         CHECK(isEqual(!m, 0.0));
     }
+
+    TEST_CASE("Blocked LU determinant on multi-panel matrices") {
+        double d3[] = {2, -3, 1, 2, 0, -1, 1, 4, 5};
+        CHECK(!SquareMat(3, d3) == doctest::Approx(49.0));
+
+        // A = L * U with unit-lower L, so det(A) = prod(diag(U))
+        const int n = 150;
+        SquareMat l = SquareMat::identity(n);
+        SquareMat u(n);
+        double expected = 1.0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < i; ++j) {
+                l[i][j] = ((i * 7 + j * 3) % 11 - 5) / 10.0;
+            }
+            u[i][i] = 1.0 + (i % 3) * 0.01;
+            expected *= u[i][i];
+            for (int j = i + 1; j < n; ++j) {
+                u[i][j] = ((i + 2 * j) % 7 - 3) / 10.0;
+            }
+        }
+        SquareMat a = l * u;
+        CHECK(!a == doctest::Approx(expected).epsilon(1e-8));
+        CHECK(!~a == doctest::Approx(expected).epsilon(1e-8));
+
+        std::copy(a.row(3).begin(), a.row(3).end(), a.row(n - 1).begin());  // duplicate row
+        CHECK(std::abs(!a) < 1e-9);
+    }
+
+    TEST_CASE("Log-determinant survives overflow and underflow") {
+        double d[] = {1, 2, 3, 4};
+        LogDeterminant small = SquareMat(2, d).logDeterminant();
+        CHECK(small.sign == -1.0);
+        CHECK(small.logAbs == doctest::Approx(std::log(2.0)));
+
+        // 600 x 600 diagonal-dominant matrices whose determinants are outside double range
+        const int n = 600;
+        SquareMat big = SquareMat::identity(n) * 10.0;
+        SquareMat tiny = SquareMat::identity(n) * 0.01;
+        big[0][1] = 3.0;
+        big[0][0] = -10.0;  // one negative pivot
+        CHECK(std::isinf(!big));
+        CHECK(!tiny == 0.0);
+        LogDeterminant lb = big.logDeterminant();
+        CHECK(lb.sign == -1.0);
+        CHECK(lb.logAbs == doctest::Approx(n * std::log(10.0)));
+        CHECK((~big).logDeterminant().sign == -1.0);
+        CHECK(tiny.logDeterminant().logAbs == doctest::Approx(n * std::log(0.01)));
+
+        LogDeterminant singular = SquareMat(3).logDeterminant();
+        CHECK(singular.sign == 0.0);
+        CHECK(std::isinf(singular.logAbs));
+        CHECK(singular.logAbs < 0.0);
+    }
 }
 
 TEST_SUITE("Comparison Operators") {
+    TEST_CASE("equals and approxEquals compare elements") {
+        double d1[] = {1, 2, 3, 4};
+        double d3[] = {4, 3, 2, 1};
+        SquareMat m1(2, d1);
+        SquareMat m3(2, d3);
+        CHECK(m1 == m3);  // same sum
+        CHECK_FALSE(m1.equals(m3));
+        CHECK(m1.equals(SquareMat(2, d1)));
+        CHECK(m1.equals(m1));
+        CHECK_FALSE(m1.equals(SquareMat(3)));
+
+        SquareMat zeros(3);
+        SquareMat negZeros = -zeros;
+        CHECK(zeros.equals(negZeros));
+
+        const int n = 20;  // mismatch past the first chunks and in the tail
+        SquareMat a = SquareMat::identity(n);
+        SquareMat b = a;
+        b[n - 1][n - 1] = std::nextafter(1.0, 2.0);
+        CHECK_FALSE(a.equals(b));
+        CHECK_FALSE(a.approxEquals(b, 0.0));
+        CHECK(a.approxEquals(b, 0.0, 0.0, 1));
+        CHECK(a.approxEquals(b, 1e-12));
+        b[n - 1][n - 1] = 1.001;
+        CHECK_FALSE(a.approxEquals(b, 0.0, 0.0, 4));
+        CHECK(a.approxEquals(b, 0.0, 1e-2));
+        CHECK_FALSE(a.approxEquals(b, 0.0, 1e-4));
+
+        b[0][1] = std::nan("");
+        SquareMat separate = b;
+        separate.data();  // non-const access gives the copy its own buffer
+        CHECK_FALSE(b.approxEquals(separate, 1.0, 1.0, 100));
+        CHECK(b.approxEquals(b, 0.0));
+    }
+
     TEST_CASE("==, !=, <=, >=, <, > based on sum") {
         double d1[] = {1, 2, 3, 4}; // sum = 10
         double d3[] = {4, 3, 2, 1}; // sum = 10
@@ -178,3 +312,1081 @@ TEST_SUITE("Compound Assignment Operators") {
         CHECK(isEqual(copy %= 3, SquareMat(2, mod)));
     }
 }
+
+TEST_SUITE("Element Access") {
+    TEST_CASE("Row spans and data() alias the matrix storage") {
+        SquareMat m(3);
+        for (int i = 0; i < 3; ++i) {
+            std::span<double> r = m.row(i);
+            CHECK(r.size() == 3);
+            for (int j = 0; j < 3; ++j) r[j] = i * 3 + j;
+        }
+        CHECK(m[1][2] == 5);
+        CHECK(m.data()[7] == 7);
+        CHECK(m.row(2).data() == m.data() + 6);
+
+        const SquareMat& cm = m;
+        CHECK(cm.row(0)[1] == 1);
+        CHECK(cm.data() == m.data());
+    }
+
+#if SQUAREMAT_CHECK_BOUNDS
+    TEST_CASE("Checked builds reject out-of-range indices") {
+        SquareMat m(2);
+        CHECK_THROWS_AS(m[2], MatrixException);
+        CHECK_THROWS_AS(m[0][2], MatrixException);
+        CHECK_THROWS_AS(m[0][-1], MatrixException);
+        CHECK_THROWS_AS(m.row(-1), MatrixException);
+    }
+#endif
+}
+
+TEST_SUITE("Iterators") {
+    static_assert(std::contiguous_iterator<decltype(std::declval<SquareMat&>().begin())>);
+    static_assert(std::random_access_iterator<StrideIterator<double>>);
+    static_assert(std::random_access_iterator<RowRange<double>::iterator>);
+    static_assert(std::random_access_iterator<ColumnRange<const double>::iterator>);
+
+    TEST_CASE("Element, row and column ranges") {
+        double d[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        SquareMat m(3, d);
+        CHECK(std::accumulate(m.begin(), m.end(), 0.0) == 45);
+        CHECK(m.end() - m.begin() == 9);
+
+        int r = 0;
+        for (std::span<double> row : m.rows()) {
+            CHECK(row[0] == 3 * r + 1);
+            ++r;
+        }
+        CHECK(r == 3);
+
+        StridedRange<double> col = m.column(1);
+        CHECK(std::vector<double>(col.begin(), col.end()) == std::vector<double>{2, 5, 8});
+        CHECK(m.columns().end() - m.columns().begin() == 3);
+        CHECK(std::accumulate(m.columns()[2].begin(), m.columns()[2].end(), 0.0) == 18);
+
+        std::reverse(col.begin(), col.end());
+        CHECK(m[0][1] == 8);
+        CHECK(m[2][1] == 2);
+    }
+
+    TEST_CASE("Parallel STL algorithms over matrix storage") {
+        const int n = 200;
+        SquareMat m(n);
+        std::iota(m.begin(), m.end(), 0.0);
+        std::transform(std::execution::par_unseq, m.begin(), m.end(), m.begin(),
+                       [](double x) { return 2 * x; });
+        double total = std::reduce(std::execution::par_unseq, m.begin(), m.end());
+        CHECK(total == doctest::Approx(2.0 * (n * n - 1.0) * n * n / 2));
+
+        StridedRange<const double> col = static_cast<const SquareMat&>(m).column(3);
+        double colSum = std::reduce(std::execution::par_unseq, col.begin(), col.end());
+        double expected = 0;
+        for (int i = 0; i < n; ++i) expected += m[i][3];
+        CHECK(colSum == doctest::Approx(expected));
+
+        std::for_each(std::execution::par_unseq, m.rows().begin(), m.rows().end(),
+                      [](std::span<double> row) { row[0] = -1; });
+        CHECK(m[n - 1][0] == -1);
+    }
+}
+
+TEST_SUITE("Lazy Transpose") {
+    // Reference product computed with the textbook triple loop
+    SquareMat naiveProduct(const SquareMat& a, const SquareMat& b) {
+        int n = a.getSize();
+        SquareMat result(n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                for (int k = 0; k < n; ++k)
+                    result[i][j] += a[i][k] * b[k][j];
+        return result;
+    }
+
+    SquareMat explicitTranspose(const SquareMat& a) {
+        int n = a.getSize();
+        SquareMat result(n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                result[j][i] = a[i][j];
+        return result;
+    }
+
+    TEST_CASE("View indexing and materialization") {
+        double d[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        SquareMat m(3, d);
+        CHECK(m[0][1] == 2);
+        CHECK((~m)[0][1] == 4);
+        CHECK((~m)[2][0] == 3);
+        CHECK(&(~~m) == &m);
+        CHECK(isEqual(!~m, !m));
+        CHECK_THROWS_AS((~m)[3], MatrixException);
+
+        SquareMat t = ~m;
+        double expected[] = {1, 4, 7, 2, 5, 8, 3, 6, 9};
+        CHECK(isEqual(t, SquareMat(3, expected)));
+        CHECK(isEqual(-~m, t * -1));
+        CHECK(isEqual((~m) ^ 2, t * t));
+    }
+
+    TEST_CASE("Kernels consume transposed operands directly") {
+        const int n = 300;  // larger than one cache tile
+        SquareMat a(n), b(n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                a[i][j] = ((i * 7 + j * 3) % 11) - 5;
+                b[i][j] = ((i * 5 + j * 13) % 7) - 3;
+            }
+        SquareMat at = explicitTranspose(a);
+        SquareMat bt = explicitTranspose(b);
+
+        CHECK(isEqual(a * b, naiveProduct(a, b)));
+        CHECK(isEqual(~a * b, naiveProduct(at, b)));
+        CHECK(isEqual(a * ~b, naiveProduct(a, bt)));
+        CHECK(isEqual(~a * ~b, naiveProduct(at, bt)));
+        CHECK(isEqual(~a + b, at + b));
+        CHECK(isEqual(a + ~b, a + bt));
+        CHECK(isEqual(~a - b, at - b));
+        CHECK(isEqual(a - ~b, a - bt));
+        CHECK(isEqual(~a - ~b, at - bt));
+        CHECK(isEqual(2 * ~a, at * 2));
+
+        SquareMat c = a;
+        c += ~c;  // aliased: must not read overwritten entries
+        CHECK(isEqual(c, a + at));
+        c = a;
+        c *= ~b;
+        CHECK(isEqual(c, naiveProduct(a, bt)));
+    }
+}
+
+TEST_SUITE("Matrix Views") {
+    TEST_CASE("Blocks address the parent storage") {
+        double d[] = {1, 2, 3, 4,
+                      5, 6, 7, 8,
+                      9, 10, 11, 12,
+                      13, 14, 15, 16};
+        SquareMat m(4, d);
+        MatrixView tile = m.block(1, 1, 2);
+        CHECK(tile[0][0] == 6);
+        CHECK(tile[1][1] == 11);
+        tile[0][1] = 70;
+        CHECK(m[1][2] == 70);
+        m[1][2] = 7;
+
+        double expected[] = {6, 7, 10, 11};
+        CHECK(isEqual(SquareMat(tile), SquareMat(2, expected)));
+        CHECK(isEqual(SquareMat(~tile), ~SquareMat(2, expected)));
+        CHECK((~m.view()).block(0, 1, 2)[0][1] == 9);  // m[2][0]
+        CHECK(tile.sum() == 34);
+        CHECK_THROWS_AS(m.block(3, 3, 2), MatrixException);
+    }
+
+    TEST_CASE("Arithmetic accepts views and writes tiles in place") {
+        double d[] = {1, 2, 3, 4,
+                      5, 6, 7, 8,
+                      9, 10, 11, 12,
+                      13, 14, 15, 16};
+        SquareMat m(4, d);
+        SquareMat topLeft(m.block(0, 0, 2));
+        SquareMat bottomRight(m.block(2, 2, 2));
+
+        CHECK(isEqual(m.block(0, 0, 2) * m.block(2, 2, 2), topLeft * bottomRight));
+        CHECK(isEqual(m.block(0, 0, 2) + bottomRight, topLeft + bottomRight));
+        CHECK(isEqual(~topLeft - m.block(2, 2, 2), SquareMat(~topLeft) - bottomRight));
+        CHECK(isEqual(m.block(0, 0, 2) * 2, topLeft * 2));
+
+        m.block(0, 0, 2) += m.block(2, 2, 2);
+        CHECK(isEqual(SquareMat(m.block(0, 0, 2)), topLeft + bottomRight));
+        CHECK(m[0][2] == 3);  // untouched outside the tile
+
+        m.block(2, 2, 2) *= m.block(2, 2, 2);
+        CHECK(isEqual(SquareMat(m.block(2, 2, 2)), bottomRight * bottomRight));
+
+        // overlapping transposed source is copied before writing
+        SquareMat s(m);
+        SquareMat expectedSum = SquareMat(s.block(0, 0, 3)) + SquareMat(~s.block(1, 1, 3));
+        s.block(0, 0, 3) += ~s.block(1, 1, 3);
+        CHECK(isEqual(SquareMat(s.block(0, 0, 3)), expectedSum));
+    }
+}
+
+TEST_SUITE("Statistics") {
+    TEST_CASE("Counters aggregate per operation and size bucket") {
+        stats::reset();
+        stats::recordOp(stats::Op::Multiply, 100, 500, 2000000, 240000);
+        stats::recordOp(stats::Op::Multiply, 120, 700, 3456000, 345600);
+        stats::recordOp(stats::Op::Multiply, 3, 10, 54, 216);
+
+        stats::Snapshot snap = stats::snapshot();
+        CHECK(stats::sizeBucket(100) == stats::sizeBucket(128));
+        CHECK(std::string(stats::bucketLabel(stats::sizeBucket(100))) == "<=128");
+        const stats::OpCounters& big = snap.at(stats::Op::Multiply, stats::sizeBucket(100));
+        CHECK(big.calls == 2);
+        CHECK(big.nanos == 1200);
+        CHECK(snap.total(stats::Op::Multiply).flops == 5456054);
+        CHECK(snap.total(stats::Op::Add).calls == 0);
+
+        std::string json = snap.toJson();
+        CHECK(json.find("\"op\":\"multiply\",\"size\":\"<=128\",\"calls\":2") != std::string::npos);
+        CHECK(snap.toText().find("multiply <=4 1 10 54 216") != std::string::npos);
+
+        stats::reset();
+        CHECK(stats::snapshot().total(stats::Op::Multiply).calls == 0);
+    }
+
+#if SQUAREMAT_STATS
+    TEST_CASE("Public operators are instrumented once per call") {
+        SquareMat a = SquareMat::identity(4);
+        SquareMat b(4);
+        stats::reset();
+        SquareMat c = a * b;  // nested copy and *= must not be counted separately
+        (void)c;
+        stats::Snapshot snap = stats::snapshot();
+        CHECK(snap.total(stats::Op::Multiply).calls == 1);
+        CHECK(snap.total(stats::Op::Multiply).flops == 128);
+        CHECK(snap.total(stats::Op::Multiply).allocations >= 1);
+        CHECK(snap.total(stats::Op::Copy).calls == 0);
+    }
+#endif
+}
+
+TEST_SUITE("In-Place Multiply") {
+    TEST_CASE("Distinct and aliased operands match the out-of-place product") {
+        const int n = 150;  // more than one row panel
+        SquareMat a(n);
+        SquareMat b(n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                a[i][j] = ((i * 7 + j) % 5) - 2.0;
+                b[i][j] = ((i + j * 3) % 7) - 3.0;
+            }
+        }
+        SquareMat expected = a * b;
+        SquareMat c = a;
+        c *= b;
+        CHECK(isEqual(c, expected));
+
+        SquareMat squared = a * a;
+        c = a;
+        const double* before = c.data();
+        std::uint64_t liveBefore = memory::usage().liveBytes;
+        c *= c;
+        CHECK(isEqual(c, squared));
+        CHECK(c.data() != before);  // the product buffer was swapped in, not copied back
+        CHECK(memory::usage().liveBytes == liveBefore);
+
+        memory::trimScratch();
+        liveBefore = memory::usage().liveBytes;
+        c = a * b;
+        c *= b;  // distinct operands: the row panel is accounted scratch
+        CHECK(memory::usage().liveBytes == liveBefore + 128 * n * sizeof(double));
+        memory::trimScratch();
+        CHECK(memory::usage().liveBytes == liveBefore);
+
+        c = a;
+        c *= ~b;
+        CHECK(isEqual(c, a * SquareMat(~b)));
+        c = a;
+        c *= ~c;
+        CHECK(isEqual(c, a * SquareMat(~a)));
+    }
+}
+
+TEST_SUITE("Output Parameters") {
+    TEST_CASE("Results match the operators, including aliased destinations") {
+        double da[] = {1, 2, 3, 4};
+        double db[] = {0, 1, 1, 0};
+        SquareMat a(2, da);
+        SquareMat b(2, db);
+        SquareMat dst(2);
+
+        add(dst, a, b);
+        CHECK(isEqual(dst, a + b));
+        subtract(dst, a, b);
+        CHECK(isEqual(dst, a - b));
+        multiply(dst, a, b);
+        CHECK(isEqual(dst, a * b));
+        multiply(dst, a, 3.0);
+        CHECK(isEqual(dst, a * 3.0));
+        divide(dst, a, 2.0);
+        CHECK(isEqual(dst, a / 2.0));
+        negate(dst, a);
+        CHECK(isEqual(dst, -a));
+        transpose(dst, a);
+        CHECK(isEqual(dst, SquareMat(~a)));
+        power(dst, a, 5);
+        CHECK(isEqual(dst, a ^ 5));
+        power(dst, a, 0);
+        CHECK(isEqual(dst, SquareMat::identity(2)));
+
+        SquareMat c = a;
+        multiply(c, c, c);
+        CHECK(isEqual(c, a * a));
+        c = a;
+        transpose(c, c);
+        CHECK(isEqual(c, SquareMat(~a)));
+        c = a;
+        power(c, c, 3);
+        CHECK(isEqual(c, a ^ 3));
+        c = a;
+        add(c, c, c);
+        CHECK(isEqual(c, a * 2.0));
+
+        SquareMat wrong(3);
+        CHECK_THROWS_AS(add(wrong, a, b), MatrixException);
+        CHECK_THROWS_AS(power(dst, a, -1), MatrixException);
+        CHECK_THROWS_AS(divide(dst, a, 0.0), MatrixException);
+    }
+
+    TEST_CASE("Steady-state loops allocate no matrices") {
+        SquareMat a = SquareMat::identity(16) * 0.5;
+        SquareMat acc(16);
+        power(acc, a, 7);  // warm the scratch buffers
+        std::uint64_t before = memory::usage().allocations;
+        for (int i = 0; i < 10; ++i) {
+            multiply(acc, acc, a);
+            add(acc, acc, a);
+            power(acc, a, 7);
+        }
+        CHECK(memory::usage().allocations == before);
+    }
+}
+
+TEST_SUITE("Async Operations") {
+    TEST_CASE("Futures deliver the synchronous results") {
+        double d[] = {2, 1, 1, 3};
+        SquareMat a(2, d);
+        SquareMat b = SquareMat::identity(2) * 2.0;
+        std::future<SquareMat> product = multiplyAsync(a, b);
+        std::future<SquareMat> sum = addAsync(a, b);
+        std::future<SquareMat> difference = subtractAsync(a, b);
+        std::future<SquareMat> power = powerAsync(a, 6);
+        std::future<double> det = determinantAsync(a);
+        std::future<LogDeterminant> logDet = logDeterminantAsync(a);
+        a[0][0] = 100;  // the tasks hold their own copies
+        SquareMat original(2, d);
+        CHECK(isEqual(product.get(), original * b));
+        CHECK(isEqual(sum.get(), original + b));
+        CHECK(isEqual(difference.get(), original - b));
+        CHECK(isEqual(power.get(), original ^ 6));
+        CHECK(det.get() == doctest::Approx(5.0));
+        CHECK(logDet.get().logAbs == doctest::Approx(std::log(5.0)));
+    }
+
+    TEST_CASE("Errors surface through get() and private pools work") {
+        ThreadPool pool(2);
+        CHECK(pool.size() == 2);
+        std::future<SquareMat> bad = multiplyAsync(SquareMat(2), SquareMat(3), pool);
+        CHECK_THROWS_AS(bad.get(), MatrixException);
+        std::vector<std::future<double>> dets;
+        for (int i = 1; i <= 8; ++i) {
+            dets.push_back(determinantAsync(SquareMat::identity(20) * 1.0 * i, pool));
+        }
+        CHECK(dets[1].get() == doctest::Approx(std::pow(2.0, 20)));
+        CHECK(dets[7].get() == doctest::Approx(std::pow(8.0, 20)));
+    }
+}
+
+TEST_SUITE("Modular Matrices") {
+    TEST_CASE("Fibonacci powers with 64-bit exponents") {
+        const std::uint64_t huge = 1000000000000000000ULL;
+        std::int64_t fib[] = {1, 1, 1, 0};
+        // one modulus per accumulation path, including the 2^32 boundary
+        CHECK((ModMat(2, 1000000007, fib) ^ huge).at(0, 1) == 209783453ULL);
+        CHECK((ModMat(2, 4294967296ULL, fib) ^ huge).at(0, 1) == 2433872443ULL);
+        CHECK((ModMat(2, (1ULL << 61) - 1, fib) ^ huge).at(0, 1) == 1024960830501646393ULL);
+        CHECK((ModMat(2, 97, fib) ^ 0) == ModMat::identity(2, 97));
+        CHECK((ModMat(2, 1, fib) ^ 5) == ModMat(2, 1));
+    }
+
+    TEST_CASE("Products match reduced schoolbook sums") {
+        for (std::uint64_t m : {7ULL, 1000000007ULL, (1ULL << 62) + 135}) {
+            int n = 37;
+            ModMat a(n, m), b(n, m);
+            std::uint64_t state = 12345;
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                    a.set(i, j, static_cast<std::int64_t>(state >> 1));
+                    b.set(j, i, -static_cast<std::int64_t>(state >> 3));
+                }
+            }
+            ModMat c = a * b;
+            for (int i : {0, 17, 36}) {
+                for (int j : {0, 5, 36}) {
+                    unsigned __int128 expected = 0;
+                    for (int k = 0; k < n; ++k) {
+                        expected = (expected + static_cast<unsigned __int128>(a.at(i, k)) * b.at(k, j)) % m;
+                    }
+                    CHECK(c.at(i, j) == static_cast<std::uint64_t>(expected));
+                }
+            }
+            CHECK(((a + b) - b) == a);
+        }
+    }
+
+    TEST_CASE("Reduction, conversion and errors") {
+        std::int64_t d[] = {-1, 10, 3, -12};
+        ModMat a(2, 5, d);
+        CHECK(a.at(0, 0) == 4);
+        CHECK(a.at(0, 1) == 0);
+        CHECK(a.at(1, 1) == 3);
+        CHECK((a * 3ULL).at(1, 0) == 4);
+        CHECK(isEqual(a.toSquareMat(), ModMat(a.toSquareMat(), 5).toSquareMat()));
+        double fractional[] = {0.5, 0, 0, 1};
+        CHECK_THROWS_AS(ModMat(SquareMat(2, fractional), 5), MatrixException);
+        CHECK_THROWS_AS(ModMat(2, 0), MatrixException);
+        CHECK_THROWS_AS(a * ModMat(2, 7), MatrixException);
+        CHECK_THROWS_AS(a + ModMat(3, 5), MatrixException);
+        CHECK_THROWS_AS(a.at(2, 0), MatrixException);
+    }
+}
+
+TEST_SUITE("Power Ladder") {
+    TEST_CASE("Ladder powers match binary exponentiation") {
+        double d[] = {0.5, 0.25, 0.0, 0.1, 0.6, 0.2, 0.3, 0.0, 0.4};
+        SquareMat a(3, d);
+        PowerLadder ladder(a);
+        for (int k : {0, 1, 2, 7, 13, 64, 100}) {
+            CHECK(isEqual(ladder.power(k), a ^ k));
+        }
+        CHECK(ladder.cachedSquares() == 7);  // up to a^64
+        SquareMat dst(3);
+        ladder.power(dst, 45);
+        CHECK(isEqual(dst, a ^ 45));
+        CHECK_THROWS_AS(ladder.power(-1), MatrixException);
+        SquareMat wrong(4);
+        CHECK_THROWS_AS(ladder.power(wrong, 2), MatrixException);
+    }
+
+    TEST_CASE("Bounded cache recomputes the high squares") {
+        double d[] = {1, 1, 0, 1};
+        SquareMat a(2, d);  // a^k = [[1, k], [0, 1]]
+        PowerLadder ladder(a, 2 * 4 * sizeof(double));  // room for two squares beyond the base
+        SquareMat p = ladder.power(1000);
+        CHECK(ladder.cachedSquares() == 3);
+        CHECK(p[0][1] == 1000.0);
+        CHECK(ladder.power(1001)[0][1] == 1001.0);
+        ladder.clear();
+        CHECK(ladder.cachedSquares() == 1);
+        PowerLadder baseOnly(a, 0);
+        CHECK(baseOnly.power(1000)[0][1] == 1000.0);
+        CHECK(baseOnly.cachedSquares() == 1);
+    }
+
+    TEST_CASE("Consecutive powers walk incrementally") {
+        double d[] = {1, 1, 0, 1};
+        SquareMat a(2, d);
+        PowerLadder ladder(a);
+        for (int k = 1; k <= 5; ++k) {
+            CHECK(ladder.next()[0][1] == k);
+            CHECK(ladder.position() == k);
+        }
+        ladder.seek(40);
+        CHECK(ladder.next()[0][1] == 41.0);
+        CHECK(a[0][1] == 1.0);  // the base is never written
+    }
+}
+
+TEST_SUITE("Task Graph") {
+    TEST_CASE("Graph results match eager evaluation") {
+        double da[] = {1, 2, 3, 4};
+        double db[] = {0, 1, 1, 0};
+        double dc[] = {2, 0, 1, 1};
+        SquareMat a(2, da), b(2, db), c(2, dc);
+        ThreadPool pool(2);
+        TaskGraph graph(pool);
+        TaskGraph::Node na = graph.input(a);
+        TaskGraph::Node nb = graph.input(b);
+        TaskGraph::Node nc = graph.input(c);
+        TaskGraph::Node d = graph.add(graph.multiply(na, nb), graph.multiply(na, nc));
+        TaskGraph::Node e = graph.multiply(graph.transpose(d), d);
+        TaskGraph::Node f = graph.subtract(graph.power(e, 3), graph.scale(d, 2.0));
+        graph.output(e);
+        graph.output(f);
+        graph.run();
+
+        SquareMat dd = a * b + a * c;
+        SquareMat ee = ~dd * dd;
+        CHECK(isEqual(graph.result(e), ee));
+        CHECK(isEqual(graph.result(f), (ee ^ 3) - dd * 2.0));
+        CHECK(isEqual(graph.result(na), a));
+        CHECK_THROWS_AS(graph.result(d), MatrixException);  // intermediate, released
+
+        graph.run();  // graphs can be re-evaluated
+        CHECK(isEqual(graph.result(e), ee));
+    }
+
+    TEST_CASE("Intermediate buffers are reused along a chain") {
+        SquareMat a = SquareMat::identity(16) * 1.0;
+        ThreadPool pool(1);
+        TaskGraph graph(pool);
+        TaskGraph::Node node = graph.input(a);
+        for (int i = 0; i < 20; ++i) {
+            node = graph.scale(node, 2.0);
+        }
+        graph.output(node);
+        std::uint64_t before = memory::usage().allocations;
+        graph.run();
+        CHECK(memory::usage().allocations - before <= 3);
+        CHECK(graph.result(node)[3][3] == std::pow(2.0, 20));
+    }
+
+    TEST_CASE("Errors propagate and skip dependents") {
+        TaskGraph graph;
+        TaskGraph::Node a = graph.input(SquareMat(2));
+        CHECK_THROWS_AS(graph.multiply(a, graph.input(SquareMat(3))), MatrixException);
+        TaskGraph::Node bad = graph.custom({a}, 2, [](SquareMat&, const std::vector<const SquareMat*>&) {
+            throw MatrixException("node failed");
+        });
+        TaskGraph::Node after = graph.add(bad, a);
+        graph.output(after);
+        CHECK_THROWS_AS(graph.run(), MatrixException);
+        CHECK_THROWS_AS(graph.result(after), MatrixException);
+    }
+}
+
+TEST_SUITE("Work-Stealing Pool") {
+    static long forkSum(ThreadPool& pool, int lo, int hi) {
+        if (hi - lo <= 64) {
+            long sum = 0;
+            for (int i = lo; i < hi; ++i) {
+                sum += i;
+            }
+            return sum;
+        }
+        int mid = lo + (hi - lo) / 2;
+        long left = 0;
+        TaskGroup group(pool);
+        group.run([&] { left = forkSum(pool, lo, mid); });
+        long right = forkSum(pool, mid, hi);
+        group.wait();
+        return left + right;
+    }
+
+    TEST_CASE("Recursive fork/join completes on any pool size") {
+        for (int threads : {1, 3}) {
+            ThreadPool pool(threads, true);
+            CHECK(pool.size() == threads);
+            CHECK(forkSum(pool, 0, 100000) == 100000L * 99999 / 2);
+            std::future<long> nested = pool.submit([&pool] { return forkSum(pool, 0, 5000); });
+            CHECK(nested.get() == 5000L * 4999 / 2);
+        }
+    }
+
+    TEST_CASE("Task groups rethrow the first failure") {
+        ThreadPool pool(2);
+        TaskGroup group(pool);
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 8; ++i) {
+            group.run([&ran, i] {
+                ++ran;
+                if (i == 3) {
+                    throw MatrixException("task failed");
+                }
+            });
+        }
+        CHECK_THROWS_AS(group.wait(), MatrixException);
+        CHECK(ran.load() == 8);
+        group.wait();  // failure was consumed
+    }
+
+    TEST_CASE("External executors run pool work") {
+        std::atomic<int> forwarded{0};
+        std::vector<std::thread> threads;
+        std::mutex threadsMutex;
+        {
+            ThreadPool pool([&](std::function<void()> task) {
+                ++forwarded;
+                std::lock_guard<std::mutex> lock(threadsMutex);
+                threads.emplace_back(std::move(task));
+            }, 4);
+            CHECK(pool.size() == 4);
+            CHECK(forkSum(pool, 0, 1000) == 1000L * 999 / 2);
+            SquareMat a = SquareMat::identity(8) * 3.0;
+            CHECK(multiplyAsync(a, a, pool).get()[7][7] == 9.0);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CHECK(forwarded.load() > 0);
+        CHECK_FALSE(ThreadPool::configureShared(2));  // shared() is already in use
+    }
+}
+
+TEST_SUITE("Copy-On-Write") {
+    TEST_CASE("Copies share storage until the first write") {
+        double d[] = {1, 2, 3, 4};
+        SquareMat a(2, d);
+        SquareMat b = a;
+        SquareMat c(3);
+        c = a;
+        const SquareMat& ca = a;
+        const SquareMat& cb = b;
+        CHECK(ca.data() == cb.data());
+        CHECK(static_cast<const SquareMat&>(c).data() == ca.data());
+
+        b[0][0] = 10;  // detaches b only
+        CHECK(ca.data() != cb.data());
+        CHECK(a[0][0] == 1);
+        CHECK(c[0][0] == 1);
+        CHECK(b[0][0] == 10);
+
+        SquareMat old = a++;  // postfix returns the shared old value
+        CHECK(old.equals(SquareMat(2, d)));
+        CHECK(a[1][1] == 5);
+
+        SquareMat product = c;
+        product *= c;  // shared operand: product goes to a fresh buffer
+        CHECK(isEqual(product, SquareMat(2, d) * SquareMat(2, d)));
+        CHECK(c.equals(SquareMat(2, d)));
+    }
+
+    TEST_CASE("Invalid compound assignments throw before detaching") {
+        SquareMat a = SquareMat::identity(4);
+        SquareMat b = a;
+        SquareMat other(3);
+        const SquareMat& ca = a;
+        const SquareMat& cb = b;
+        auto message = [](auto&& op) -> std::string {
+            try {
+                op();
+            } catch (const MatrixException& e) {
+                return e.msg;
+            }
+            return "";
+        };
+        memory::setBudget(memory::usage().liveBytes);  // a private copy would not fit
+        CHECK(message([&] { b += other; }) == "Matrices must have the same dimensions for +=");
+        CHECK(message([&] { b -= other; }) == "Matrices must have the same dimensions for -=");
+        CHECK(message([&] { b += ~other; }) == "Matrices must have the same dimensions for +=");
+        CHECK(message([&] { b -= ~other; }) == "Matrices must have the same dimensions for -=");
+        CHECK(message([&] { b %= other; }) == "Matrices must have the same dimensions for element-wise multiplication");
+        CHECK(message([&] { b /= 0.0; }) == "Division by zero");
+        CHECK(message([&] { b %= 0; }) == "Modulo by zero is undefined");
+        memory::setBudget(0);
+        CHECK(ca.data() == cb.data());  // still shared
+    }
+
+    TEST_CASE("A writable matrix detaches again after being copied or hashed") {
+        SquareMat w(2);
+        w[0][0] = 1;  // private buffer: later writes only test a flag
+        SquareMat snapshot = w;
+        const SquareMat& frozen = snapshot;
+        w[0][0] = 2;
+        CHECK(frozen[0][0] == 1);
+        CHECK(w[0][0] == 2);
+
+        std::uint64_t allocations = memory::usage().allocations;
+        for (int i = 0; i < 100; ++i) {
+            w[i % 2][1] += 1.0;
+        }
+        CHECK(memory::usage().allocations == allocations);
+
+        std::uint64_t before = w.hash();
+        w[1][1] = 5;
+        CHECK(w.hash() != before);
+        w = snapshot;
+        w[1][0] = 7;  // assignment shared the buffer again
+        CHECK(frozen[1][0] == 0);
+    }
+
+    TEST_CASE("Concurrent copies and reads of a shared matrix") {
+        SquareMat source = SquareMat::identity(64) * 3.0;
+        std::vector<std::thread> readers;
+        std::vector<double> sums(4);
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&source, &sums, t] {
+                for (int i = 0; i < 200; ++i) {
+                    SquareMat copy = source;
+                    if (i % 50 == 0) {
+                        copy[0][0] += 1.0;  // private copy, source unaffected
+                    }
+                    sums[t] = copy.sum();
+                }
+            });
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        for (double sum : sums) {
+            CHECK(sum == 192.0);
+        }
+        CHECK(source.sum() == 192.0);
+    }
+}
+
+TEST_SUITE("Hashing") {
+    TEST_CASE("Content hash follows equals()") {
+        double d1[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        double d2[] = {9, 8, 7, 6, 5, 4, 3, 2, 1};
+        SquareMat a(3, d1);
+        SquareMat b(3, d2);
+        CHECK(a.hash() == SquareMat(3, d1).hash());
+        CHECK(a.hash() != b.hash());
+        CHECK(SquareMat(2).hash() != SquareMat(3).hash());
+
+        SquareMat zeros(5);
+        CHECK(zeros.hash() == (-zeros).hash());  // -0 hashes like +0
+
+        std::uint64_t before = a.hash();
+        a[2][2] = 10;  // mutation through the API drops a cached hash
+        CHECK(a.hash() != before);
+        a[2][2] = 9;
+        CHECK(a.hash() == before);
+        a *= 2.0;
+        CHECK(a.hash() != before);
+    }
+
+    TEST_CASE("std::hash keys an unordered_map by content") {
+        double d[] = {1, 2, 3, 4};
+        std::unordered_map<SquareMat, int, std::hash<SquareMat>, ContentEqual> cache;
+        cache[SquareMat(2, d)] = 1;
+        cache[SquareMat::identity(2)] = 2;
+        double swapped[] = {4, 3, 2, 1};  // same sum, different content
+        cache[SquareMat(2, swapped)] = 3;
+        CHECK(cache.size() == 3);
+        CHECK(cache.at(SquareMat(2, d)) == 1);
+        CHECK(std::hash<SquareMat>()(SquareMat(2, d)) == SquareMat(2, d).hash());
+    }
+
+    TEST_CASE("Concurrent const readers hash and copy one matrix") {
+        SquareMat shared = SquareMat::identity(48) * 1.5;
+        const SquareMat& source = shared;
+        std::uint64_t expected = SquareMat(source).hash();
+        std::vector<std::thread> readers;
+        std::vector<int> mismatches(4, 0);
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&source, &mismatches, expected, t] {
+                for (int i = 0; i < 200; ++i) {
+                    SquareMat copy = source;  // reads the cache word while others fill it
+                    mismatches[t] += source.hash() != expected;
+                    mismatches[t] += copy.hash() != expected;
+                }
+            });
+        }
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        for (int count : mismatches) {
+            CHECK(count == 0);
+        }
+    }
+}
+
+TEST_SUITE("Fused GEMM") {
+    TEST_CASE("C = alpha * op(A) * op(B) + beta * C matches the operator form") {
+        const int n = 40;
+        SquareMat a(n);
+        SquareMat b(n);
+        SquareMat c(n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                a[i][j] = ((i * 3 + j) % 7) - 3.0;
+                b[i][j] = ((i + j * 5) % 9) - 4.0;
+                c[i][j] = (i == j) ? 2.0 : 0.5;
+            }
+        }
+        SquareMat expected = c * 0.5 + a * b * 2.0;
+        SquareMat fused = c;
+        gemm(2.0, a, b, 0.5, fused);
+        CHECK(isEqual(fused, expected));
+
+        SquareMat expectedT = c * 0.5 + SquareMat(~a) * SquareMat(~b) * 2.0;
+        fused = c;
+        fused[0][0] = fused[0][0];  // detach before measuring
+        memory::trimScratch();
+        std::uint64_t live = memory::usage().liveBytes;
+        gemm(2.0, a, b, 0.5, fused, true, true);
+        CHECK(isEqual(fused, expectedT));
+        CHECK(memory::usage().liveBytes == live + n * n * sizeof(double));  // packed B^T, accounted
+        memory::trimScratch();
+
+        SquareMat wrong(3);
+        CHECK_THROWS_AS(gemm(1.0, a, b, 0.0, wrong), MatrixException);
+    }
+
+    TEST_CASE("Aliased output falls back to a temporary") {
+        double d[] = {1, 2, 3, 4};
+        SquareMat a(2, d);
+        SquareMat expected = a * a * 0.1 + a * 0.9;
+        gemm(0.1, a, a, 0.9, a);
+        CHECK(isEqual(a, expected));
+    }
+}
+
+TEST_SUITE("Matrix-Vector Products") {
+    TEST_CASE("m * x and x^T * m match the dense product") {
+        double d[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        SquareMat m(3, d);
+        std::vector<double> x = {1, 0, -1};
+        std::vector<double> mx = m * x;
+        CHECK(mx == std::vector<double>{-2, -2, -2});
+        std::vector<double> xm = x * m;
+        CHECK(xm == std::vector<double>{-6, -6, -6});
+
+        std::vector<double> y(3);
+        m.multiplyVector(x, y);
+        CHECK(y == mx);
+        memory::trimScratch();
+        std::uint64_t live = memory::usage().liveBytes;
+        m.multiplyVector(y, y);  // aliasing input and output is allowed
+        CHECK(y == std::vector<double>{-12, -30, -48});
+        CHECK(memory::usage().liveBytes == live + 3 * sizeof(double));  // the temporary is leased scratch
+        memory::trimScratch();
+        memory::setBudget(live);
+        CHECK_THROWS_AS(m.multiplyVectorLeft(y, y), MatrixException);
+        memory::setBudget(0);
+
+        std::vector<double> wrong(2);
+        CHECK_THROWS_AS(m.multiplyVector(x, wrong), MatrixException);
+    }
+
+    TEST_CASE("Large products agree with SquareMat multiplication") {
+        const int n = 300;
+        SquareMat m(n);
+        std::vector<double> x(n);
+        for (int i = 0; i < n; ++i) {
+            x[i] = (i % 13) - 6.0;
+            for (int j = 0; j < n; ++j) {
+                m[i][j] = ((i * 31 + j * 17) % 19) - 9.0;
+            }
+        }
+        SquareMat column(n);
+        for (int i = 0; i < n; ++i) {
+            column[i][0] = x[i];
+        }
+        SquareMat expected = m * column;
+        SquareMat expectedLeft = ~m * column;
+        std::vector<double> mx = m * std::span<const double>(x);
+        std::vector<double> xm = std::span<const double>(x) * m;
+        for (int i = 0; i < n; ++i) {
+            CHECK(mx[i] == expected[i][0]);
+            CHECK(xm[i] == expectedLeft[i][0]);
+        }
+    }
+}
+
+TEST_SUITE("Memory Accounting") {
+    TEST_CASE("Live and peak bytes follow matrix lifetimes") {
+        const std::uint64_t bytes = 64 * 64 * sizeof(double);
+        memory::Usage before = memory::usage();
+        memory::resetPeak();
+        {
+            SquareMat a(64);
+            SquareMat b(64);
+            SquareMat c = a;  // copies share the buffer until written
+            memory::Usage during = memory::usage();
+            CHECK(during.liveBytes - before.liveBytes >= 2 * bytes);
+            CHECK(during.liveBytes - before.liveBytes < 3 * bytes);
+            CHECK(during.allocations == before.allocations + 2);
+            CHECK(during.sizeHistogram[memory::sizeClass(bytes + sizeof(double))] >=
+                  before.sizeHistogram[memory::sizeClass(bytes + sizeof(double))] + 2);
+        }
+        memory::Usage after = memory::usage();
+        CHECK(after.liveBytes == before.liveBytes);
+        CHECK(after.peakBytes >= before.liveBytes + 2 * bytes);
+        CHECK(after.releases == before.releases + 2);
+    }
+
+    TEST_CASE("Budget makes allocations fail fast") {
+        SquareMat a = SquareMat::identity(32);
+        memory::setBudget(memory::usage().liveBytes + 41 * 41 * sizeof(double));
+        CHECK_NOTHROW(SquareMat(40));
+        CHECK_THROWS_AS(SquareMat(64), MatrixException);
+        SquareMat small(8);
+        memory::setBudget(memory::usage().liveBytes);
+        CHECK_NOTHROW(small = a);  // sharing needs no memory
+        CHECK_THROWS_AS(small *= 2.0, MatrixException);  // the private copy does
+        CHECK(small.equals(a));  // a failed write leaves the target untouched
+        memory::setBudget(0);
+        CHECK(memory::usage().rejected >= 1);
+        CHECK_NOTHROW(SquareMat(64));
+    }
+
+    TEST_CASE("Scratch buffers are accounted, bounded and trimmed") {
+        const std::uint64_t bytes = 64 * 64 * sizeof(double);
+        SquareMat a = SquareMat::identity(64) * 0.5;
+        SquareMat dst(64);
+        memory::trimScratch();
+        std::uint64_t live = memory::usage().liveBytes;
+        power(dst, a, 5);  // three scratch slots
+        CHECK(memory::usage().liveBytes == live + 3 * bytes);
+        memory::trimScratch();
+        CHECK(memory::usage().liveBytes == live);
+
+        std::uint64_t retention = memory::scratchRetention();
+        memory::setScratchRetention(bytes - 1);
+        power(dst, a, 5);
+        CHECK(memory::usage().liveBytes == live);  // too large to keep
+        memory::setScratchRetention(retention);
+
+        memory::setBudget(live + bytes);
+        CHECK_THROWS_AS(power(dst, a, 5), MatrixException);
+        memory::setBudget(0);
+        memory::trimScratch();
+        {
+            SquareMat eye = SquareMat::identity(64);
+            memory::setBudget(memory::usage().liveBytes);
+            power(dst, a, 1);  // a copy and the identity lease nothing
+            CHECK(dst.equals(a));
+            power(dst, a, 0);
+            CHECK(dst.equals(eye));
+            memory::setBudget(0);
+        }
+        memory::trimScratch();
+        CHECK(memory::usage().liveBytes == live);
+    }
+}
+
+TEST_SUITE("Latency Histograms") {
+    TEST_CASE("Buckets reproduce values within their resolution") {
+        for (std::uint64_t v : {0ull, 1ull, 63ull, 64ull, 1000ull, 123456ull, 987654321ull}) {
+            int index = stats::LatencyHistogram::bucketIndex(v);
+            CHECK(stats::LatencyHistogram::bucketLowest(index) <= v);
+            CHECK(stats::LatencyHistogram::bucketHighest(index) >= v);
+            CHECK(stats::LatencyHistogram::bucketHighest(index) - stats::LatencyHistogram::bucketLowest(index) <= v / 32);
+        }
+        CHECK(stats::LatencyHistogram::bucketIndex(stats::LatencyHistogram::MAX_VALUE) ==
+              stats::LatencyHistogram::BUCKETS - 1);
+    }
+
+    TEST_CASE("Percentiles and merge") {
+        stats::LatencyHistogram fast;
+        stats::LatencyHistogram slow;
+        for (std::uint64_t v = 1; v <= 990; ++v) {
+            fast.record(v * 100);
+        }
+        for (std::uint64_t v = 1; v <= 10; ++v) {
+            slow.record(10000000 * v);
+        }
+        CHECK(std::abs(static_cast<double>(fast.percentile(50.0)) - 49500.0) <= 49500.0 * 0.035);
+        fast.merge(slow);
+        CHECK(fast.count() == 1000);
+        CHECK(fast.percentile(99.0) <= 99000 * 1.035);
+        CHECK(fast.percentile(99.9) >= 90000000);
+        CHECK(fast.max() >= 100000000);
+        CHECK(fast.min() == 100);
+    }
+
+    TEST_CASE("Per-thread recordings are merged on query") {
+        stats::reset();
+        stats::recordLatency(stats::Op::Multiply, 200, 5000);
+        std::thread worker([] {
+            for (int i = 0; i < 99; ++i) {
+                stats::recordLatency(stats::Op::Multiply, 200, 1000);
+            }
+        });
+        worker.join();
+        stats::LatencyHistogram h = stats::latency(stats::Op::Multiply, stats::sizeBucket(200));
+        CHECK(h.count() == 100);
+        CHECK(h.percentile(50.0) <= 1031);
+        CHECK(h.percentile(100.0) >= 5000);
+        CHECK(stats::latency(stats::Op::Multiply).count() == 100);
+        CHECK(stats::latencyText().find("multiply <=256 100 ") != std::string::npos);
+        stats::reset();
+        CHECK(stats::latency(stats::Op::Multiply).count() == 0);
+    }
+}
+
+TEST_SUITE("Tracing") {
+    TEST_CASE("Per-thread rings flush to Chrome trace JSON") {
+        std::ostringstream discard;
+        trace::flush(discard);  // start from empty rings
+
+        trace::record(trace::Event{"multiply", "gemm-nn-blocked", 64, 1500, 2250});
+        std::thread worker([] { trace::record(trace::Event{"determinant", "lu", 8, 4000, 10}); });
+        worker.join();
+
+        std::ostringstream out;
+        trace::flush(out);
+        std::string json = out.str();
+        CHECK(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+        CHECK(json.find("\"name\":\"multiply\",\"cat\":\"squaremat\",\"ph\":\"X\",\"ts\":1.500,\"dur\":2.250") != std::string::npos);
+        CHECK(json.find("\"args\":{\"n\":64,\"algorithm\":\"gemm-nn-blocked\"}") != std::string::npos);
+        CHECK(json.find("\"name\":\"determinant\"") != std::string::npos);
+
+        std::ostringstream again;
+        trace::flush(again);  // flushing drains the rings
+        CHECK(again.str().find("\"ph\":\"X\"") == std::string::npos);
+    }
+
+#if SQUAREMAT_TRACE
+    TEST_CASE("Operations emit nested events while tracing is on") {
+        std::ostringstream discard;
+        trace::flush(discard);
+        SquareMat a = SquareMat::identity(3);
+        trace::start();
+        SquareMat b = a * a;
+        trace::stop();
+        std::ostringstream out;
+        trace::flush(out);
+        CHECK(out.str().find("\"name\":\"multiply\"") != std::string::npos);
+        CHECK(out.str().find("gemm-nn-blocked") != std::string::npos);
+    }
+#endif
+}
+
+TEST_SUITE("Low-Rank Matrices") {
+    TEST_CASE("Dense form, products and updates match dense arithmetic") {
+        double u[] = {1, 0, 2, 1, 0, 3};   // 3x2
+        double v[] = {1, 1, 0, 2, 1, 0};   // 3x2
+        LowRankMat lr(3, 2, u, v);
+        SquareMat dense = lr.toDense();
+        double expectedDense[] = {1, 0, 1, 3, 2, 2, 3, 6, 0};
+        CHECK(isEqual(dense, SquareMat(3, expectedDense)));
+
+        double d[] = {1, 2, 0, -1, 3, 1, 2, 0, 4};
+        SquareMat a(3, d);
+        CHECK(isEqual((a * lr).toDense(), a * dense));
+        CHECK(isEqual((lr * a).toDense(), dense * a));
+        CHECK(isEqual((lr * lr).toDense(), dense * dense));
+        CHECK(isEqual(a + lr, a + dense));
+        CHECK(isEqual(lr + a, a + dense));
+        CHECK(isEqual(a - lr, a - dense));
+        CHECK(isEqual((~lr).toDense(), ~dense));
+    }
+
+    TEST_CASE("Low-rank sums concatenate factors") {
+        double u[] = {1, 2};
+        double v[] = {3, 4};
+        LowRankMat lr(2, 1, u, v);
+        LowRankMat sum = lr + lr * 2;
+        CHECK(sum.getRank() == 2);
+        CHECK(isEqual(sum.toDense(), lr.toDense() * 3));
+        CHECK(isEqual((lr - lr).toDense(), SquareMat(2)));
+
+        LowRankMat other(3, 1);
+        CHECK_THROWS_AS(lr + other, MatrixException);
+        CHECK_THROWS_AS(SquareMat(3) + lr, MatrixException);
+        CHECK_THROWS_AS(LowRankMat(2, 0), MatrixException);
+    }
+
+    TEST_CASE("Factors are budgeted and failed updates leave the matrix intact") {
+        double u[] = {1, 2};
+        double v[] = {3, 4};
+        LowRankMat lr(2, 1, u, v);
+        LowRankMat wide(2, 3);
+        std::uint64_t live = memory::usage().liveBytes;
+        memory::setBudget(live + 2 * sizeof(double));  // one factor, not two
+        CHECK_THROWS_AS(LowRankMat(2, 1), MatrixException);
+        CHECK(memory::usage().liveBytes == live);  // the first factor is released
+        CHECK_THROWS_AS(lr += lr, MatrixException);
+        CHECK_THROWS_AS(lr = wide, MatrixException);
+        memory::setBudget(0);
+        CHECK(memory::usage().liveBytes == live);
+        CHECK(lr.getRank() == 1);
+        CHECK(lr.getU()[1] == 2.0);
+        CHECK(lr.getV()[1] == 4.0);
+
+        SquareMat a(64);
+        LowRankMat big(64, 8);
+        memory::trimScratch();
+        live = memory::usage().liveBytes;
+        a += big;  // V^T scratch is leased from the memory layer
+        CHECK(memory::usage().liveBytes == live + 64 * 8 * sizeof(double));
+        memory::trimScratch();
+        CHECK(memory::usage().liveBytes == live);
+    }
+}